@@ -0,0 +1,135 @@
+/******************************************************************************
+ *
+ * Module: ADC
+ *
+ * File Name: adc.c
+ *
+ * Description: Source file for the ATmega32 ADC driver (interrupt driven, free running)
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "adc.h"
+#include "common_macros.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h> /* To restart the moving average */
+#include "lockfree.h" /* To read the 16-bit results without tearing */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Circular sample buffer and the running sum of its content, written by the ADC ISR only */
+static volatile uint16 g_samples[ADC_BUFFER_SIZE];
+static volatile uint16 g_sum = 0;
+static volatile uint8 g_index = 0;
+static volatile uint16 g_lastSample = 0;
+
+static void (*volatile g_ADC_CallBackPtr)(uint16 average) = NULL_PTR;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Select the reference voltage and the prescaler, the converter is enabled
+ * but no conversion is started.
+ */
+void ADC_init(void)
+{
+	/* REFS1:0 = reference, ADLAR = 0 (right adjusted), MUX4:0 = channel 0 */
+	ADMUX = (uint8)(ADC_REFERENCE << REFS0);
+	/* ADEN = 1 enable the ADC, ADPS2:0 = prescaler, no conversion running */
+	ADCSRA = (1 << ADEN) | ADC_PRESCALER_SELECT;
+}
+
+/*
+ * Description :
+ * Start converting the required channel (0..7) continuously in free running mode.
+ * Every result is stored in the sample buffer by the ADC interrupt.
+ */
+void ADC_startFreeRunning(uint8 channel_num)
+{
+	uint8 i;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		/* Restart the moving average from an empty buffer */
+		for(i = 0; i < ADC_BUFFER_SIZE; i++)
+		{
+			g_samples[i] = 0;
+		}
+		g_sum = 0;
+		g_index = 0;
+		g_lastSample = 0;
+
+		/* Select the channel, keep the reference bits */
+		ADMUX = (ADMUX & 0xE0) | (channel_num & 0x07);
+		/* ADTS2:0 = 000 free running mode */
+		SFIOR &= ~((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0));
+		/* ADATE = 1 auto trigger, ADIE = 1 interrupt, ADSC = 1 start the first conversion */
+		ADCSRA |= (1 << ADATE) | (1 << ADIE) | (1 << ADSC);
+	}
+}
+
+/*
+ * Description :
+ * Stop the free running conversions.
+ */
+void ADC_stop(void)
+{
+	CLEAR_BIT(ADCSRA,ADATE);
+	CLEAR_BIT(ADCSRA,ADIE);
+}
+
+/*
+ * Description :
+ * Return the latest converted sample.
+ */
+uint16 ADC_getSample(void)
+{
+	return LF_read16(&g_lastSample);
+}
+
+/*
+ * Description :
+ * Return the average of the last ADC_BUFFER_SIZE samples.
+ */
+uint16 ADC_getAverage(void)
+{
+	return LF_read16(&g_sum) >> ADC_BUFFER_SHIFT;
+}
+
+/*
+ * Description :
+ * Save the address of the function called from the ADC interrupt with the
+ * moving average after every conversion.
+ */
+void ADC_setCallBack(void(*a_ptr)(uint16 average))
+{
+	g_ADC_CallBackPtr = a_ptr;
+}
+
+/*******************************************************************************
+ *                      Interrupt Service Routines                             *
+ *******************************************************************************/
+
+ISR(ADC_vect)
+{
+	uint16 sample = ADC;
+	uint8 index = g_index;
+
+	/* Replace the oldest sample, the running sum keeps the average O(1) */
+	g_sum = g_sum - g_samples[index] + sample;
+	g_samples[index] = sample;
+	g_index = (index + 1) & (ADC_BUFFER_SIZE - 1);
+	g_lastSample = sample;
+
+	if(g_ADC_CallBackPtr != NULL_PTR)
+	{
+		(*g_ADC_CallBackPtr)(g_sum >> ADC_BUFFER_SHIFT);
+	}
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * Module: ADC
+ *
+ * File Name: adc.h
+ *
+ * Description: Header file for the ATmega32 ADC driver (interrupt driven, free running)
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef ADC_H_
+#define ADC_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define ADC_MAXIMUM_VALUE           1023
+
+/* Reference voltage selection (REFS1:0) and its value in mV */
+#define ADC_REF_AREF                0
+#define ADC_REF_AVCC                1
+#define ADC_REF_INTERNAL_2_56V      3
+#define ADC_REFERENCE               ADC_REF_AVCC
+#define ADC_REF_VOLT_MV             5000
+
+/*
+ * Clock prescaler selection (ADPS2:0), the ADC clock should be 50-200 kHz for 10-bit results.
+ * The smallest prescaler within 200 kHz is selected (fastest conversions):
+ * F_CPU/64 = 125 kHz @ 8MHz, one conversion every 13 ADC clocks = 9.6k samples/s.
+ */
+#if ((F_CPU / 2) <= 200000)
+#define ADC_PRESCALER_SELECT        1
+#define ADC_PRESCALER               2
+#elif ((F_CPU / 4) <= 200000)
+#define ADC_PRESCALER_SELECT        2
+#define ADC_PRESCALER               4
+#elif ((F_CPU / 8) <= 200000)
+#define ADC_PRESCALER_SELECT        3
+#define ADC_PRESCALER               8
+#elif ((F_CPU / 16) <= 200000)
+#define ADC_PRESCALER_SELECT        4
+#define ADC_PRESCALER               16
+#elif ((F_CPU / 32) <= 200000)
+#define ADC_PRESCALER_SELECT        5
+#define ADC_PRESCALER               32
+#elif ((F_CPU / 64) <= 200000)
+#define ADC_PRESCALER_SELECT        6
+#define ADC_PRESCALER               64
+#else
+#define ADC_PRESCALER_SELECT        7
+#define ADC_PRESCALER               128
+#endif
+
+#if (((F_CPU / ADC_PRESCALER) < 50000) || ((F_CPU / ADC_PRESCALER) > 200000))
+#error "No ADC prescaler gives an ADC clock within 50-200 kHz for this F_CPU"
+#endif
+
+/* Samples kept for the moving average, power of 2 so the average is a shift */
+#define ADC_BUFFER_SHIFT            2
+#define ADC_BUFFER_SIZE             (1 << ADC_BUFFER_SHIFT)
+
+/* Convert a voltage in mV to ADC counts */
+#define ADC_MV_TO_COUNTS(mv)        ((uint16)(((uint32)(mv) * (ADC_MAXIMUM_VALUE + 1)) / ADC_REF_VOLT_MV))
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Select the reference voltage and the prescaler, the converter is enabled
+ * but no conversion is started.
+ */
+void ADC_init(void);
+
+/*
+ * Description :
+ * Start converting the required channel (0..7) continuously in free running mode.
+ * Every result is stored in the sample buffer by the ADC interrupt.
+ */
+void ADC_startFreeRunning(uint8 channel_num);
+
+/*
+ * Description :
+ * Stop the free running conversions.
+ */
+void ADC_stop(void);
+
+/*
+ * Description :
+ * Return the latest converted sample.
+ */
+uint16 ADC_getSample(void);
+
+/*
+ * Description :
+ * Return the average of the last ADC_BUFFER_SIZE samples.
+ */
+uint16 ADC_getAverage(void);
+
+/*
+ * Description :
+ * Save the address of the function called from the ADC interrupt with the
+ * moving average after every conversion.
+ */
+void ADC_setCallBack(void(*a_ptr)(uint16 average));
+
+#endif /* ADC_H_ */
@@ -1,5 +1,80 @@
 #include "gpio.h"
 #include "buzzer.h"
+#include "timer.h"
+#include "pwm.h" /* For PWM_BACKEND, Timer1 can't be used for both */
+#include <util/atomic.h> /* To switch patterns without racing the tick interrupt */
+
+#if (BUZZER_TYPE == BUZZER_PASSIVE) && (PWM_BACKEND == PWM_BACKEND_TIMER1)
+#error "The passive buzzer tone needs Timer1, select the PWM Timer0 backend or an active buzzer"
+#endif
+
+/* Pattern table, a pattern is played once or repeated until Buzzer_off */
+typedef struct
+{
+	const Buzzer_StepType * steps;
+	uint8 length;
+	uint8 repeat;
+}Buzzer_PatternConfigType;
+
+/* Alarm: two tone siren */
+static const Buzzer_StepType g_alarmSteps[] = {
+	{BUZZER_TONE(2000), 250}, {BUZZER_TONE(1000), 250}
+};
+/* Lockout: slow beeps */
+static const Buzzer_StepType g_lockoutSteps[] = {
+	{BUZZER_TONE(1000), 500}, {BUZZER_SILENCE, 500}
+};
+/* Confirmation: two short high beeps */
+static const Buzzer_StepType g_confirmSteps[] = {
+	{BUZZER_TONE(2500), 80}, {BUZZER_SILENCE, 60}, {BUZZER_TONE(2500), 80}
+};
+
+#define BUZZER_STEPS(steps)     (steps), (uint8)(sizeof(steps) / sizeof(steps[0]))
+
+/* In the Buzzer_PatternType order */
+static const Buzzer_PatternConfigType g_patterns[] = {
+	{BUZZER_STEPS(g_alarmSteps), TRUE},
+	{BUZZER_STEPS(g_lockoutSteps), TRUE},
+	{BUZZER_STEPS(g_confirmSteps), FALSE}
+};
+
+/* Current pattern, NULL_PTR when nothing is played, and the position inside it */
+static const Buzzer_PatternConfigType * volatile g_pattern = NULL_PTR;
+static volatile uint8 g_continuous = FALSE;
+static uint8 g_step = 0;
+static uint16 g_stepTime = 0;
+#if (BUZZER_TYPE == BUZZER_PASSIVE)
+static uint8 g_pinLevel = LOGIC_LOW;
+#endif
+
+#if (BUZZER_TYPE == BUZZER_PASSIVE)
+/* Timer1 compare callback, toggles the pin at twice the tone frequency */
+static void Buzzer_toggle(void)
+{
+	g_pinLevel ^= LOGIC_HIGH;
+	GPIO_writePinFast(BUZZER_PORT_ID, BUZZER_PIN_ID, g_pinLevel);
+}
+#endif
+
+/* Start (or silence) a tone, O(1) */
+static void Buzzer_setTone(uint16 tone)
+{
+#if (BUZZER_TYPE == BUZZER_PASSIVE)
+	if(tone != BUZZER_SILENCE)
+	{
+		Timer_ConfigType toneConfig = {0, tone, TIMER1, CLOCK_8, COMPARE_MODE};
+		Timer_init(&toneConfig);
+	}
+	else
+	{
+		Timer_deInit(TIMER1);
+		g_pinLevel = LOGIC_LOW;
+		GPIO_writePinFast(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_LOW);
+	}
+#else
+	GPIO_writePinFast(BUZZER_PORT_ID, BUZZER_PIN_ID, (tone != BUZZER_SILENCE) ? LOGIC_HIGH : LOGIC_LOW);
+#endif
+}
 
 /* Initialize the buzzer pin as output and turn it off initially */
 void Buzzer_init(void)
@@ -9,16 +84,77 @@ void Buzzer_init(void)
 
     /* Turn off the buzzer */
     GPIO_writePin(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_LOW);
+
+#if (BUZZER_TYPE == BUZZER_PASSIVE)
+    Timer_setCallBack(Buzzer_toggle, TIMER1);
+#endif
 }
 
-/* Turn on the buzzer */
+/* Play the default tone continuously (stops any pattern) */
 void Buzzer_on(void)
 {
-    GPIO_writePin(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_HIGH);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_pattern = NULL_PTR;
+		g_continuous = TRUE;
+		Buzzer_setTone(BUZZER_DEFAULT_TONE);
+	}
 }
 
-/* Turn off the buzzer */
+/* Stop the tone or the pattern being played */
 void Buzzer_off(void)
 {
-    GPIO_writePin(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_LOW);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_pattern = NULL_PTR;
+		g_continuous = FALSE;
+		Buzzer_setTone(BUZZER_SILENCE);
+	}
+}
+
+/* Start playing a pattern from its first step, O(1), the pattern runs from Buzzer_tick */
+void Buzzer_play(Buzzer_PatternType pattern)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_continuous = FALSE;
+		g_pattern = &g_patterns[pattern];
+		g_step = 0;
+		g_stepTime = 0;
+		Buzzer_setTone(g_pattern->steps[0].tone);
+	}
+}
+
+/* Return TRUE while a pattern or the continuous tone is playing */
+uint8 Buzzer_isPlaying(void)
+{
+	return ((g_pattern != NULL_PTR) || g_continuous) ? TRUE : FALSE;
+}
+
+/* Advance the pattern cadence, should be called from the 1 kHz system tick */
+void Buzzer_tick(void)
+{
+	const Buzzer_PatternConfigType * pattern = g_pattern;
+
+	if(pattern == NULL_PTR)
+	{
+		return;
+	}
+
+	if(++g_stepTime >= pattern->steps[g_step].duration_ms)
+	{
+		g_stepTime = 0;
+		if(++g_step >= pattern->length)
+		{
+			if(pattern->repeat == FALSE)
+			{
+				/* End of a one-shot pattern */
+				g_pattern = NULL_PTR;
+				Buzzer_setTone(BUZZER_SILENCE);
+				return;
+			}
+			g_step = 0;
+		}
+		Buzzer_setTone(pattern->steps[g_step].tone);
+	}
 }
@@ -9,9 +9,57 @@
 #define BUZZER_PORT_ID  PORTC_ID
 #define BUZZER_PIN_ID   PIN7_ID
 
+/*
+ * Buzzer type:
+ * BUZZER_ACTIVE  : the buzzer has its own oscillator, the pin is only switched on/off (cadence only).
+ * BUZZER_PASSIVE : the pin is toggled at the tone frequency from the Timer1 compare interrupt
+ *                  (kHz rate ISR, needs a passive buzzer part).
+ * The current board has an active buzzer.
+ */
+#define BUZZER_ACTIVE   0
+#define BUZZER_PASSIVE  1
+
+#ifndef BUZZER_TYPE
+#define BUZZER_TYPE     BUZZER_ACTIVE
+#endif
+
+/* Timer1 runs at F_CPU/8 and toggles the pin twice per period */
+#define BUZZER_TIMER_PRESCALER  8
+#define BUZZER_TONE(hz)         ((uint16)((F_CPU / (2UL * BUZZER_TIMER_PRESCALER * (hz))) - 1))
+#define BUZZER_SILENCE          0
+
+/* Tone used by Buzzer_on */
+#define BUZZER_DEFAULT_TONE     BUZZER_TONE(2000)
+
+/* Patterns played by Buzzer_play */
+typedef enum
+{
+	BUZZER_PATTERN_ALARM,BUZZER_PATTERN_LOCKOUT,BUZZER_PATTERN_CONFIRM
+}Buzzer_PatternType;
+
+/* One step of a pattern: the tone (BUZZER_TONE(hz) or BUZZER_SILENCE) and how long it lasts */
+typedef struct
+{
+	uint16 tone;
+	uint16 duration_ms;
+}Buzzer_StepType;
+
 /* Function Prototypes */
 void Buzzer_init(void);
+
+/* Play the default tone continuously (stops any pattern) */
 void Buzzer_on(void);
+
+/* Stop the tone or the pattern being played */
 void Buzzer_off(void);
 
+/* Start playing a pattern from its first step, O(1), the pattern runs from Buzzer_tick */
+void Buzzer_play(Buzzer_PatternType pattern);
+
+/* Return TRUE while a pattern or the continuous tone is playing */
+uint8 Buzzer_isPlaying(void);
+
+/* Advance the pattern cadence, should be called from the 1 kHz system tick */
+void Buzzer_tick(void);
+
 #endif /* BUZZER_H_ */
@@ -0,0 +1,114 @@
+/******************************************************************************
+ *
+ * Module: Clock
+ *
+ * File Name: clock.h
+ *
+ * Description: Header file for the monotonic ms/us clock
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include "std_types.h"
+#include "timer.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * The clock counts the compare matches of the system tick timer (1 kHz) and adds the
+ * timer counter for the us. The prescaler is the smallest one giving an exact 1 ms period
+ * in 8 bits and a whole number of us per count: F_CPU/64 = 8us per count @ 8MHz,
+ * 4us @ 16MHz, F_CPU/8 = 8us @ 1MHz.
+ * The timer is never stopped or reloaded after Clock_init.
+ */
+#define CLOCK_TIMER                   TIMER2  /* Timer2 is the Control_ECU system tick */
+#define CLOCK_TICK_COUNTER            TCNT2
+#define CLOCK_TICK_FLAG               OCF2
+
+/* TRUE if the prescaler gives an exact 1 ms period of at most 256 counts of whole us */
+#define CLOCK_PRESCALER_FITS(prescaler) \
+	(((F_CPU % ((prescaler) * 1000UL)) == 0) && ((F_CPU / ((prescaler) * 1000UL)) <= 256) && \
+	 (((prescaler) * 1000000UL) % F_CPU == 0))
+
+#if CLOCK_PRESCALER_FITS(8)
+#define CLOCK_PRESCALER               8
+#define CLOCK_PRESCALER_SELECT        CLOCK_8
+#elif CLOCK_PRESCALER_FITS(64)
+#define CLOCK_PRESCALER               64
+#define CLOCK_PRESCALER_SELECT        CLOCK_64
+#elif CLOCK_PRESCALER_FITS(256)
+#define CLOCK_PRESCALER               256
+#define CLOCK_PRESCALER_SELECT        CLOCK_256
+#else
+#error "No timer prescaler gives an exact 1 ms tick with whole us counts at this F_CPU"
+#endif
+
+#define CLOCK_TICK_TOP                ((F_CPU / (CLOCK_PRESCALER * 1000UL)) - 1)
+#define CLOCK_US_PER_COUNT            ((CLOCK_PRESCALER * 1000000UL) / F_CPU)
+
+/*
+ * Wrap-safe time comparisons, valid while the two times are less than half the
+ * counter range apart (24.8 days in ms, 35.7 minutes in us).
+ * Never compare two times directly, a < b is wrong across the wrap.
+ */
+#define CLOCK_ELAPSED(now, since)     ((uint32)((uint32)(now) - (uint32)(since)))
+#define CLOCK_IS_AFTER(a, b)          ((sint32)((uint32)(a) - (uint32)(b)) > 0)
+#define CLOCK_IS_REACHED(now, deadline) ((sint32)((uint32)(now) - (uint32)(deadline)) >= 0)
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start the clock timer in compare mode with a 1 ms period. With TIMER_DISPATCH_RUNTIME
+ * the tick handler should be set by Timer_setCallBack before.
+ */
+void Clock_init(void);
+
+/*
+ * Description :
+ * Count one ms, should be called first in the system tick interrupt.
+ */
+void Clock_tick(void);
+
+/*
+ * Description :
+ * Return the ms since Clock_init (wraps after 49.7 days), safe from the ISRs and the main loop.
+ */
+uint32 Clock_millis(void);
+
+/*
+ * Description :
+ * Return the us since Clock_init with the timer resolution (wraps after 71.6 minutes),
+ * safe from the ISRs and the main loop.
+ */
+uint32 Clock_micros(void);
+
+/*
+ * Description :
+ * Return TRUE once the ms clock reached the deadline (a previous Clock_millis() + timeout).
+ */
+uint8 Clock_isExpired(uint32 deadline_ms);
+
+/*
+ * Description :
+ * Return the timer count within the current ms. Read first in the tick interrupt, it
+ * marks the ISR entry before Clock_tick for Clock_elapsedUs.
+ */
+uint8 Clock_getCount(void);
+
+/*
+ * Description :
+ * Return the us since the timer count was read with Clock_getCount, for intervals
+ * shorter than 1 ms (e.g. the duration of an interrupt handler).
+ */
+uint16 Clock_elapsedUs(uint8 start_count);
+
+#endif /* CLOCK_H_ */
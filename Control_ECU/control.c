@@ -9,6 +9,7 @@
 #include <util/delay.h>
 #include <avr/interrupt.h>
 #include <avr/io.h>
+#include <util/atomic.h>
 #include "std_types.h"
 #include "uart.h"
 #include "buzzer.h"
@@ -19,6 +20,16 @@
 #include "string.h"
 #include "util/delay.h"
 #include "timer.h"
+#include "link.h"
+#include "trace.h"
+#include "perf.h"
+#include "histogram.h"
+#include "stack.h"
+#include "pool.h"
+#include "lockfree.h"
+#include "work.h"
+#include "clock.h"
+#include "power.h"
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -35,79 +46,196 @@
 #define ALARM_MODE					0x19
 #define CHANGE_PASSWORD				0x20
 #define MAX_TRIES                  3
+#define PASSWORD_ADDRESS			0x0311
+#define LOCKOUT_TIME_MS				60000
+
+/*
+ * Provisioned header, written after the password: magic, version, password size, CRC-8 of the
+ * password. The door boots straight to VERIFY when it is valid, a blank (0xFF) EEPROM or a reset
+ * between the two writes fails the check and the door asks for a new password.
+ */
+#define PROVISION_ADDRESS			0x0300 /* Own 16-byte EEPROM page, the password is in the next one */
+#define PROVISION_HEADER_SIZE		4
+#define PROVISION_MAGIC				0xA5
+#define PROVISION_VERSION			1
+#define PROVISION_CRC_POLYNOMIAL	0x07
+
+/*
+ * Startup handshake: Control_ECU sends the boot status when it is ready and whenever
+ * HMI_ECU asks for it (HMI_ECU started after Control_ECU).
+ * payload = boot state, TRUE if waiting for a password, ready time since the clock start in us (4 bytes)
+ */
+#define BOOT_QUERY_FRAME			0x02
+#define BOOT_STATUS_FRAME			0x03
+#define BOOT_SETUP					0 /* No valid password, HMI_ECU should ask for a new one */
+#define BOOT_PROVISIONED			1
+
+/* Passwords are sent as ASCII digits terminated by '#', any other byte is a command */
+#define PASSWORD_END				'#'
+
+/*
+ * Door status frame sent to HMI_ECU every STATUS_PERIOD_MS:
+ * payload = phase, percent complete, seconds remaining, flags
+ */
+#define DOOR_STATUS_FRAME			0x01
+#define STATUS_PERIOD_MS			250
+#define DOOR_LOCKED					0
+#define DOOR_UNLOCKING				1
+#define DOOR_OPEN					2
+#define DOOR_LOCKING				3
+#define DOOR_LOCKOUT				4
+#define DOOR_FLAG_OCCUPIED			0x01
 
 /*******************************************************************************
- *                           Global Variables                                  *
+ *                               Types Declaration                             *
  *******************************************************************************/
 
-static volatile uint8 g_ticks = 0;
+/*
+ * Control_ECU states:
+ * SETUP      : waiting for a new password and its confirmation.
+ * VERIFY     : waiting for a password to check against the saved one.
+ * AUTHORIZED : password accepted, waiting for the action (open door / change password).
+ * UNLOCKING  : the bolt is moving to the unlocked position.
+ * OPEN       : door unlocked, waiting until nobody moved for PIR_HOLD_TIME_MS.
+ * LOCKING    : the bolt is moving to the locked position.
+ * LOCKOUT    : MAX_TRIES wrong passwords, alarm for LOCKOUT_TIME_MS.
+ */
+typedef enum
+{
+	STATE_SETUP,STATE_VERIFY,STATE_AUTHORIZED,STATE_UNLOCKING,STATE_OPEN,STATE_LOCKING,STATE_LOCKOUT,
+	STATE_COUNT,
+	STATE_SAME = STATE_COUNT /* Returned by a handler to stay in the current state */
+}Control_StateType;
+
+typedef enum
+{
+	EVENT_PASSWORD,   /* A complete password was received from HMI_ECU */
+	EVENT_COMMAND,    /* A command byte was received from HMI_ECU */
+	EVENT_MOTOR_DONE, /* The door move finished */
+	EVENT_VACANT,     /* Nobody in front of the door for PIR_HOLD_TIME_MS */
+	EVENT_TIMEOUT,    /* The state timer expired */
+	EVENT_COUNT
+}Control_EventType;
+
+/* Handlers run in the main loop, each one finishes in bounded time and returns the next state */
+typedef Control_StateType (*Control_HandlerType)(void);
+typedef void (*Control_EntryType)(void);
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
-void getAndSavePassword(void);
-void countOneSecond(void);
-void Timer1_DelaySecond(uint8 time);
 void initializeSystem(void);
-void handleDoorControl(uint8 action);
+/* Static so the compiler can inline it into the timer ISR (TIMER_DISPATCH_STATIC) */
+static void systemTick(void);
+void motorMoveDone(void);
+void doorVacant(void);
+void startStateTimer(uint16 time_ms);
+void pollLink(void);
+void handleFrame(void);
+void dispatchEvent(Control_EventType event);
+void enterState(Control_StateType state);
+void sendStatus(void);
+void eventWork(uint8 event);
+void statusWork(uint8 arg);
+uint8 provisionChecksum(const uint8 *data, uint8 size);
+uint8 isProvisioned(void);
+uint8 saveProvisioned(uint8 *password);
+void sendBootStatus(void);
+
+void enterSetup(void);
+void enterVerify(void);
+void enterUnlocking(void);
+void enterOpen(void);
+void enterLocking(void);
+void enterLockout(void);
+Control_StateType setupPassword(void);
+Control_StateType verifyPassword(void);
+Control_StateType authorizedCommand(void);
+Control_StateType unlockDone(void);
+Control_StateType doorIsVacant(void);
+Control_StateType lockDone(void);
+Control_StateType lockoutDone(void);
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Entry action of each state (NULL_PTR if none), in the Control_StateType order */
+static const Control_EntryType g_entryTable[STATE_COUNT] = {
+	enterSetup, enterVerify, NULL_PTR, enterUnlocking, enterOpen, enterLocking, enterLockout
+};
+
+/* Event handlers of each state (NULL_PTR = event ignored in this state) */
+static const Control_HandlerType g_stateTable[STATE_COUNT][EVENT_COUNT] = {
+	/*                  PASSWORD        COMMAND            MOTOR_DONE  VACANT        TIMEOUT     */
+	/* SETUP      */ {setupPassword,  NULL_PTR,          NULL_PTR,   NULL_PTR,     NULL_PTR},
+	/* VERIFY     */ {verifyPassword, NULL_PTR,          NULL_PTR,   NULL_PTR,     NULL_PTR},
+	/* AUTHORIZED */ {NULL_PTR,       authorizedCommand, NULL_PTR,   NULL_PTR,     NULL_PTR},
+	/* UNLOCKING  */ {NULL_PTR,       NULL_PTR,          unlockDone, NULL_PTR,     NULL_PTR},
+	/* OPEN       */ {NULL_PTR,       NULL_PTR,          NULL_PTR,   doorIsVacant, NULL_PTR},
+	/* LOCKING    */ {NULL_PTR,       NULL_PTR,          lockDone,   NULL_PTR,     NULL_PTR},
+	/* LOCKOUT    */ {NULL_PTR,       NULL_PTR,          NULL_PTR,   NULL_PTR,     lockoutDone}
+};
+
+static Control_StateType g_state = STATE_SETUP;
+
+/* State timer in ms, counted down by the system tick */
+static volatile uint16 g_stateTimer = 0;
+/* The status frame is posted by the system tick every STATUS_PERIOD_MS */
+static uint8 g_statusTime = 0;
+
+/*
+ * Link input: the password being received, the last complete password and the last command.
+ * The passwords are received in place in pool blocks and handed to the state handlers by
+ * reference, NULL_PTR if the pool was empty (the password is then invalid).
+ */
+static uint8 *g_rxPassword = NULL_PTR;
+static uint8 g_rxLength = 0;
+static uint8 *g_password = NULL_PTR;
+static uint8 g_passwordValid = FALSE;
+static uint8 g_command = 0;
+
+/* Start times (Clock_micros) of the latencies kept in the histograms */
+static uint32 g_passwordTime = 0;
+static uint32 g_unlockTime = 0;
+
+/* First entry of a new password (block kept by setupPassword), and the number of wrong passwords in a row */
+static uint8 *g_newPassword = NULL_PTR;
+static uint8 g_newPasswordReceived = FALSE;
+static uint8 g_newPasswordValid = FALSE;
+static uint8 g_tries = 0;
+
+/* Time from the clock start to the first state (clock time base in us), sent in the boot status */
+static uint32 g_readyTime = 0;
 
 /*******************************************************************************
  *                                    Main                                     *
  *******************************************************************************/
 
 int main(void){
-	uint8 size = PASSWORD_SIZE + 1;
-	uint8 enteredPass[size], savedPass[size];
-	uint8 action = 0;
-
 	// Initialize the system components
 	initializeSystem();
 
-	/* Get the password from HMI_ECU and save it in the External EEPRPOM */
-	getAndSavePassword();
-	_delay_ms(10);
+	/*
+	 * Fast boot: a door with a valid provisioned header waits for the password at once,
+	 * otherwise get the password from HMI_ECU and save it in the External EEPROM
+	 */
+	enterState(isProvisioned() ? STATE_VERIFY : STATE_SETUP);
+	g_readyTime = Clock_micros();
+	TRACE_POINT(TRACE_BOOT_READY, (g_state == STATE_VERIFY) ? TRUE : FALSE);
+	/* Tell HMI_ECU which screen to start with */
+	sendBootStatus();
 
 	for(;;){
-		uint8 loop_counter;
-
-		/* loop 3 times until the user enters the correct password */
-		for(loop_counter = 0; loop_counter < MAX_TRIES; loop_counter++){
-			/* Send CONTROL_ECU_READY byte to HMI_ECU to ask it to send the password */
-			UART_sendByte(CONTROL_ECU_READY);
-			/* Receive the password from HMI_ECU through UART */
-			UART_receiveString(enteredPass);
-
-			/* Get the password saved in the EEPROM */
-			EEPROM_readData(0x0311, savedPass, PASSWORD_SIZE);
-			savedPass[PASSWORD_SIZE] = '\0';
-
-			/* Compare the received password with the saved password */
-			if(!strcmp((char*)enteredPass, (char*)savedPass)){
-				/* If the two passwords match, send TRUE_PASSWORD byte to HMI_ECU */
-				UART_sendByte(TRUE_PASSWORD);
-				/* Receive an action byte from HMI_ECU (Open Door or Change Password) */
-				action = UART_recieveByte();
-				break;
-			}else{
-				/* If the passwords don't match, send WRONG_PASSWORD byte to HMI_ECU */
-				UART_sendByte(WRONG_PASSWORD);
-			}
-		}
+		/* Bytes received from HMI_ECU */
+		pollLink();
 
-		/* If the user entered the wrong password 3 times */
-		if(loop_counter == MAX_TRIES){
-			/* Activate the buzzer to alert the user */
-			Buzzer_on();
-			/* Wait for 60 seconds before deactivating the buzzer */
-			Timer1_DelaySecond(60);
-			Buzzer_off();
-		}
-		/* If the user entered the correct password */
-		else{
-			/* Handle the door control based on the action received */
-			handleDoorControl(action);
-		}
+		/* Events posted by the interrupts: state machine events first, then the door status stream */
+		WORK_process();
+
+		/* Nothing left to do: sleep until the next interrupt (UART byte, system tick, ADC) */
+		POWER_SLEEP_UNLESS(UART_isDataAvailable() || WORK_isPending());
 	}
 }
 
@@ -117,18 +245,20 @@ int main(void){
  */
 void initializeSystem(void){
 	/* Create configuration structure for UART driver */
-	UART_ConfigType uartConfig = {EIGHT_BITS, NO_PARITY, ONE_STOP_BIT, 9600};
+	UART_ConfigType uartConfig = {EIGHT_BITS, NO_PARITY, ONE_STOP_BIT, UART_BAUD_RATE};
 	/* Enable Global Interrupt */
 	sei();
+	/* Initialize the buffer pool used by the link input */
+	POOL_init();
 	/* Initialize the UART driver with:
-	 * Baud-rate = 9600 bits/sec, one stop bit, No parity, 8-bit data
+	 * Baud-rate = UART_BAUD_RATE (9600 bits/sec), one stop bit, No parity, 8-bit data
 	 */
 	UART_init(&uartConfig);
 
 	/* Create configuration structure for TWI/I2C driver */
-	TWI_ConfigType twiConfig = {0x01, 0x02};
+	TWI_ConfigType twiConfig = {0x01, TWI_SCL_FREQUENCY};
 	/* Initialize the TWI driver with:
-	 * My address = 0x01, bit rate = 0x02, SCL frequency = 400 Hz
+	 * My address = 0x01, SCL frequency = TWI_SCL_FREQUENCY (100 kHz)
 	 */
 	TWI_init(&twiConfig);
 
@@ -136,97 +266,478 @@ void initializeSystem(void){
 	Buzzer_init();
 	/* Initialize the DC Motor */
 	DcMotor_Init();
-	/* Initialize the PIR Sensor */
+	/* Initialize the PIR Sensor, doorVacant is called when nobody moved for PIR_HOLD_TIME_MS */
 	PIR_init();
+	PIR_setCallBack(doorVacant);
+
+	/* Start the clock, its 1 kHz tick runs the drivers */
+#if (TIMER2_DISPATCH == TIMER_DISPATCH_RUNTIME)
+	Timer_setCallBack(systemTick, TIMER2);
+#endif
+	Clock_init();
+	/* The main loop sleeps in idle mode when it has nothing to do */
+	POWER_init();
 }
 
 /*
  * Description :
- * Function responsible for getting the password from HMI_ECU and saving it in the External EEPROM.
+ * Read the bytes received from HMI_ECU without blocking. Frames are handled by
+ * handleFrame, digits are collected until '#' then EVENT_PASSWORD is dispatched,
+ * any other byte is EVENT_COMMAND.
  */
-void getAndSavePassword(void){
-	uint8 size = PASSWORD_SIZE + 1;
-	uint8 pass1[size], pass2[size];
+void pollLink(void){
+	uint8 data;
 
-	/* Loop until the user enters the same password twice for confirmation */
-	for(;;){
-		/* Send CONTROL_ECU_READY byte to HMI_ECU to ask it to send the two passwords */
-		UART_sendByte(CONTROL_ECU_READY);
-		/* Receive the password and the confirmation password from HMI_ECU */
-		UART_receiveString(pass1);
-		UART_receiveString(pass2);
-
-		/* Compare the two passwords */
-		if(!strcmp((char*)pass1, (char*)pass2)){
-			/* If the two passwords are the same, save the password in EEPROM */
-			EEPROM_writeData(0x0311, pass1, PASSWORD_SIZE);
-			/* Send PASSWORD_SAVED byte to HMI_ECU */
-			UART_sendByte(PASSWORD_SAVED);
-			return;
+	while(UART_readByte(&data)){
+		LINK_ParseResultType result;
+
+		POWER_eventHandled();
+		result = LINK_parseByte(data);
+
+		if(result == LINK_FRAME_READY){
+			handleFrame();
+		}else if(result == LINK_FRAME_BUSY){
+			/* Byte taken by the frame parser */
+		}else if(data == PASSWORD_END){
+			TRACE_POINT(TRACE_PASSWORD_RECEIVED, g_rxLength);
+			g_passwordTime = Clock_micros();
+			/* A password longer than PASSWORD_SIZE is kept invalid so it never matches */
+			g_password = g_rxPassword;
+			g_rxPassword = NULL_PTR;
+			g_passwordValid = ((g_rxLength == PASSWORD_SIZE) && (g_password != NULL_PTR)) ? TRUE : FALSE;
+			if(g_password != NULL_PTR){
+				g_password[PASSWORD_SIZE] = '\0';
+			}
+			g_rxLength = 0;
+			dispatchEvent(EVENT_PASSWORD);
+			/* Give the block back unless the handler kept it */
+			POOL_free(g_password);
+			g_password = NULL_PTR;
+		}else if((data >= '0') && (data <= '9')){
+			if(g_rxLength == 0){
+				g_rxPassword = (uint8 *)POOL_alloc();
+			}
+			if((g_rxLength < PASSWORD_SIZE) && (g_rxPassword != NULL_PTR)){
+				g_rxPassword[g_rxLength] = data;
+			}
+			if(g_rxLength < 0xFF){
+				g_rxLength++;
+			}
 		}else{
-			/* If the two passwords are not the same, send DIFF_PASSWORDS byte to HMI_ECU */
-			UART_sendByte(DIFF_PASSWORDS);
+			TRACE_POINT(TRACE_COMMAND_RECEIVED, data);
+			g_command = data;
+			dispatchEvent(EVENT_COMMAND);
 		}
 	}
 }
 
 /*
  * Description :
- * Function to handle the door control logic (unlock and lock).
- * Action parameter determines if the door should be unlocked or if the password should be changed.
+ * Handle a frame received on the link (the debug commands).
+ */
+void handleFrame(void){
+	LINK_FrameType *frame = LINK_getFrame();
+
+	if(frame->type == TRACE_DUMP_REQUEST_FRAME){
+		TRACE_dump();
+	}else if(frame->type == PERF_QUERY_FRAME){
+		PERF_send();
+	}else if(frame->type == HIST_QUERY_FRAME){
+		HIST_send();
+	}else if(frame->type == STACK_QUERY_FRAME){
+		STACK_send();
+	}else if(frame->type == POOL_QUERY_FRAME){
+		POOL_send();
+	}else if(frame->type == WORK_QUERY_FRAME){
+		WORK_send();
+	}else if(frame->type == POWER_QUERY_FRAME){
+		POWER_send();
+	}else if(frame->type == MOTOR_TRAVEL_QUERY_FRAME){
+		DcMotor_sendTravelStats();
+	}else if(frame->type == BOOT_QUERY_FRAME){
+		sendBootStatus();
+	}
+	LINK_freeFrame(frame);
+}
+
+/*
+ * Description :
+ * Run the handler of the event in the current state, then enter the returned state.
+ */
+void dispatchEvent(Control_EventType event){
+	Control_HandlerType handler = g_stateTable[g_state][event];
+	Control_StateType next;
+
+	if(handler == NULL_PTR){
+		/* Event not expected in this state */
+		return;
+	}
+	next = handler();
+	if(next != STATE_SAME){
+		enterState(next);
+	}
+}
+
+/*
+ * Description :
+ * Change the current state and run its entry action.
+ */
+void enterState(Control_StateType state){
+	g_state = state;
+	if(g_entryTable[state] != NULL_PTR){
+		(*g_entryTable[state])();
+	}
+}
+
+/*
+ * Description :
+ * Send the door status frame: phase, percent complete, seconds remaining and PIR occupancy.
  */
-void handleDoorControl(uint8 action){
-	/* Process Open Door option */
-	if(action == UNLOCK_DOOR){
-		/* Rotate the motor clockwise to unlock the door */
-		DcMotor_Rotate(ACW, 100);
-		/* Wait until the door is unlocked for 15 seconds */
-		Timer1_DelaySecond(15);
-		/* Stop the motor to keep the door open */
-		DcMotor_Rotate(STOP, 0);
+void sendStatus(void){
+	uint8 status[4];
+	uint16 remaining_ms = 0;
+	DcMotor_ProgressType progress;
 
-		/* Wait until PIR sensor detects no motion (all people enter) */
-		while(PIR_getState());
+	switch(g_state){
+	case STATE_UNLOCKING:
+	case STATE_LOCKING:
+		DcMotor_getProgress(&progress);
+		status[0] = (g_state == STATE_UNLOCKING) ? DOOR_UNLOCKING : DOOR_LOCKING;
+		status[1] = progress.percent;
+		remaining_ms = progress.remaining_ms;
+		break;
+	case STATE_OPEN:
+		/* Time until the door locks if nobody moves */
+		status[0] = DOOR_OPEN;
+		status[1] = 100;
+		remaining_ms = PIR_getHoldTimeRemaining();
+		break;
+	case STATE_LOCKOUT:
+		status[0] = DOOR_LOCKOUT;
+		remaining_ms = LF_read16(&g_stateTimer);
+		status[1] = (uint8)(((uint32)(LOCKOUT_TIME_MS - remaining_ms) * 100) / LOCKOUT_TIME_MS);
+		break;
+	default:
+		status[0] = DOOR_LOCKED;
+		status[1] = 100;
+		break;
+	}
+	/* Whole seconds, rounded up */
+	status[2] = (uint8)((remaining_ms + 999) / 1000);
+	status[3] = PIR_isOccupied() ? DOOR_FLAG_OCCUPIED : 0;
+
+	LINK_sendFrame(DOOR_STATUS_FRAME, status, sizeof(status));
+}
+
+/*
+ * Description :
+ * Send the boot status frame: boot state, waiting for a password and the ready time.
+ */
+void sendBootStatus(void){
+	uint8 status[6];
+
+	status[0] = (g_state == STATE_SETUP) ? BOOT_SETUP : BOOT_PROVISIONED;
+	status[1] = ((g_state == STATE_SETUP) || (g_state == STATE_VERIFY)) ? TRUE : FALSE;
+	status[2] = (uint8)g_readyTime;
+	status[3] = (uint8)(g_readyTime >> 8);
+	status[4] = (uint8)(g_readyTime >> 16);
+	status[5] = (uint8)(g_readyTime >> 24);
+
+	LINK_sendFrame(BOOT_STATUS_FRAME, status, sizeof(status));
+}
+
+/*
+ * Description :
+ * CRC-8 (polynomial 0x07) of the password kept in the provisioned header.
+ */
+uint8 provisionChecksum(const uint8 *data, uint8 size){
+	uint8 crc = 0;
+	uint8 bit;
 
-		/* Send LOCKING_DOOR byte to HMI_ECU */
-		UART_sendByte(LOCKING_DOOR);
-		/* Rotate the motor anti-clockwise to lock the door */
-		DcMotor_Rotate(CW, 100);
-		/* Wait until the door is locked for 15 seconds */
-		Timer1_DelaySecond(15);
-		/* Stop the motor */
-		DcMotor_Rotate(STOP, 0);
+	while(size--){
+		crc ^= *data++;
+		for(bit = 0; bit < 8; bit++){
+			crc = (crc & 0x80) ? (uint8)((crc << 1) ^ PROVISION_CRC_POLYNOMIAL) : (uint8)(crc << 1);
+		}
 	}
-	/* Process Change Password option */
-	else if(action == CHANGE_PASSWORD){
-		/* Get the new password from HMI_ECU and save it in the External EEPROM */
-		getAndSavePassword();
-		_delay_ms(10);
+	return crc;
+}
+
+/*
+ * Description :
+ * Return TRUE if the External EEPROM holds a valid provisioned header and the password it covers.
+ */
+uint8 isProvisioned(void){
+	uint8 header[PROVISION_HEADER_SIZE];
+	uint8 password[PASSWORD_SIZE];
+
+	if((EEPROM_readData(PROVISION_ADDRESS, header, PROVISION_HEADER_SIZE) != SUCCESS) ||
+	   (EEPROM_readData(PASSWORD_ADDRESS, password, PASSWORD_SIZE) != SUCCESS)){
+		return FALSE;
 	}
+	return ((header[0] == PROVISION_MAGIC) && (header[1] == PROVISION_VERSION) &&
+			(header[2] == PASSWORD_SIZE) && (header[3] == provisionChecksum(password, PASSWORD_SIZE))) ? TRUE : FALSE;
+}
+
+/*
+ * Description :
+ * Save the password then its provisioned header in the External EEPROM.
+ * The header is written last, a reset in between leaves a header that does not match.
+ */
+uint8 saveProvisioned(uint8 *password){
+	uint8 header[PROVISION_HEADER_SIZE];
+
+	header[0] = PROVISION_MAGIC;
+	header[1] = PROVISION_VERSION;
+	header[2] = PASSWORD_SIZE;
+	header[3] = provisionChecksum(password, PASSWORD_SIZE);
+
+	if(EEPROM_writeData(PASSWORD_ADDRESS, password, PASSWORD_SIZE) != SUCCESS){
+		return ERROR;
+	}
+	return EEPROM_writeData(PROVISION_ADDRESS, header, PROVISION_HEADER_SIZE);
+}
+
+/*******************************************************************************
+ *                      State Entry Actions                                    *
+ *******************************************************************************/
+
+/* Ask HMI_ECU for the new password and its confirmation */
+void enterSetup(void){
+	g_newPasswordReceived = FALSE;
+	UART_sendByte(CONTROL_ECU_READY);
+}
+
+/* Ask HMI_ECU for the password to check */
+void enterVerify(void){
+	UART_sendByte(CONTROL_ECU_READY);
+}
+
+/* Move the bolt to the unlocked position (the move runs from the system tick) */
+void enterUnlocking(void){
+	TRACE_POINT(TRACE_MOTOR_START, MOTOR_UNLOCKED_POSITION);
+	DcMotor_moveTo(MOTOR_UNLOCKED_POSITION, motorMoveDone);
+}
+
+/* Wait until nobody moved in front of the door for PIR_HOLD_TIME_MS (all people enter) */
+void enterOpen(void){
+	PIR_restartHoldTime();
+}
+
+/* Tell HMI_ECU then move the bolt to the locked position */
+void enterLocking(void){
+	UART_sendByte(LOCKING_DOOR);
+	TRACE_POINT(TRACE_MOTOR_START, MOTOR_LOCKED_POSITION);
+	DcMotor_moveTo(MOTOR_LOCKED_POSITION, motorMoveDone);
+}
+
+/* Play the lockout pattern to alert the user, the tone runs from the interrupts */
+void enterLockout(void){
+	PERF_COUNT(PERF_LOCKOUTS);
+	Buzzer_play(BUZZER_PATTERN_LOCKOUT);
+	startStateTimer(LOCKOUT_TIME_MS);
+}
+
+/*******************************************************************************
+ *                      State Event Handlers                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * SETUP, password received: keep the first one, compare the second one with it
+ * and save the password in the External EEPROM if they are the same.
+ */
+Control_StateType setupPassword(void){
+	Control_StateType next;
+	uint8 status = ERROR;
+
+	if(!g_newPasswordReceived){
+		/* HMI_ECU always sends both passwords, keep the first one and wait for the confirmation */
+		g_newPassword = g_password;
+		g_password = NULL_PTR;
+		g_newPasswordValid = g_passwordValid;
+		g_newPasswordReceived = TRUE;
+		return STATE_SAME;
+	}
+
+	if(g_newPasswordValid && g_passwordValid && !strcmp((char*)g_newPassword, (char*)g_password)){
+		/* If the two passwords are the same, save the password and the provisioned header in EEPROM */
+		uint32 start = Clock_micros();
+		status = saveProvisioned(g_newPassword);
+		HIST_record(HIST_EEPROM, Clock_micros() - start);
+	}
+
+	if(status == SUCCESS){
+		/* Send PASSWORD_SAVED byte to HMI_ECU */
+		UART_sendByte(PASSWORD_SAVED);
+		next = STATE_VERIFY;
+	}else{
+		/* If the two passwords are not the same (or could not be saved), send DIFF_PASSWORDS byte to HMI_ECU and ask again */
+		UART_sendByte(DIFF_PASSWORDS);
+		next = STATE_SETUP;
+	}
+	POOL_free(g_newPassword);
+	g_newPassword = NULL_PTR;
+	return next;
+}
+
+/*
+ * Description :
+ * VERIFY, password received: compare it with the password saved in the External EEPROM.
+ */
+Control_StateType verifyPassword(void){
+	uint8 savedPass[PASSWORD_SIZE + 1];
+	uint8 status;
+	uint8 match;
+	uint32 start;
+
+	PERF_COUNT(PERF_PASSWORD_ATTEMPTS);
+
+	/* Get the password saved in the EEPROM */
+	TRACE_POINT(TRACE_EEPROM_READ_START, 0);
+	start = Clock_micros();
+	status = EEPROM_readData(PASSWORD_ADDRESS, savedPass, PASSWORD_SIZE);
+	HIST_record(HIST_EEPROM, Clock_micros() - start);
+	TRACE_POINT(TRACE_EEPROM_READ_END, status);
+	savedPass[PASSWORD_SIZE] = '\0';
+
+	match = (g_passwordValid && !strcmp((char*)g_password, (char*)savedPass)) ? TRUE : FALSE;
+	TRACE_POINT(TRACE_COMPARE_DONE, match);
+
+	if(match){
+		/* If the two passwords match, send TRUE_PASSWORD byte to HMI_ECU */
+		g_tries = 0;
+		UART_sendByte(TRUE_PASSWORD);
+		TRACE_POINT(TRACE_VERDICT_SENT, TRUE_PASSWORD);
+		HIST_record(HIST_VERIFY, Clock_micros() - g_passwordTime);
+		Buzzer_play(BUZZER_PATTERN_CONFIRM);
+		return STATE_AUTHORIZED;
+	}
+
+	/* If the passwords don't match, send WRONG_PASSWORD byte to HMI_ECU */
+	UART_sendByte(WRONG_PASSWORD);
+	TRACE_POINT(TRACE_VERDICT_SENT, WRONG_PASSWORD);
+	HIST_record(HIST_VERIFY, Clock_micros() - g_passwordTime);
+	if(++g_tries >= MAX_TRIES){
+		/* The user entered the wrong password 3 times */
+		g_tries = 0;
+		return STATE_LOCKOUT;
+	}
+	return STATE_VERIFY;
+}
+
+/*
+ * Description :
+ * AUTHORIZED, command received: open the door or change the password.
+ */
+Control_StateType authorizedCommand(void){
+	if(g_command == UNLOCK_DOOR){
+		g_unlockTime = Clock_micros();
+		return STATE_UNLOCKING;
+	}else if(g_command == CHANGE_PASSWORD){
+		return STATE_SETUP;
+	}
+	return STATE_SAME;
+}
+
+/* UNLOCKING, move finished */
+Control_StateType unlockDone(void){
+	HIST_record(HIST_UNLOCK, Clock_micros() - g_unlockTime);
+	return STATE_OPEN;
+}
+
+/* OPEN, nobody in front of the door */
+Control_StateType doorIsVacant(void){
+	/* The event can be stale: posted before entering OPEN restarted the hold time */
+	if(PIR_isOccupied()){
+		return STATE_SAME;
+	}
+	return STATE_LOCKING;
+}
+
+/* LOCKING, move finished, wait for the next password */
+Control_StateType lockDone(void){
+	return STATE_VERIFY;
+}
+
+/* LOCKOUT, alarm time elapsed */
+Control_StateType lockoutDone(void){
+	Buzzer_off();
+	return STATE_VERIFY;
+}
+
+/*******************************************************************************
+ *                      Deferred Work Items                                    *
+ *******************************************************************************/
+
+/* Event posted by an interrupt, run from the main loop */
+void eventWork(uint8 event) {
+	POWER_eventHandled();
+	dispatchEvent((Control_EventType)event);
+}
+
+/* Door status period elapsed, run from the main loop */
+void statusWork(uint8 arg) {
+	(void)arg;
+	sendStatus();
+}
+
+/*******************************************************************************
+ *                      Interrupt Callbacks                                    *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * System tick callback (1 kHz), counts the clock, runs the motor motion profile,
+ * the PIR hold time, the buzzer patterns, the state timer and the status period.
+ * Its duration from the ISR entry is the longest time with the interrupts disabled,
+ * it is reported to the work queue.
+ */
+static void systemTick(void) {
+	/* Read before anything else so the clock update is part of the measured time */
+	uint8 start = Clock_getCount();
+
+	/* The clock is only valid once this tick is counted */
+	Clock_tick();
+	DcMotor_tick();
+	PIR_tick();
+	Buzzer_tick();
+	if((g_stateTimer != 0) && (--g_stateTimer == 0)){
+		WORK_post(eventWork, EVENT_TIMEOUT, WORK_PRIORITY_NORMAL);
+	}
+	if(++g_statusTime >= STATUS_PERIOD_MS){
+		g_statusTime = 0;
+		WORK_post(statusWork, 0, WORK_PRIORITY_LOW);
+	}
+	WORK_recordIrqOff(Clock_elapsedUs(start));
+}
+
+#if (TIMER2_DISPATCH == TIMER_DISPATCH_STATIC)
+/* The system tick is bound to the Timer2 compare interrupt at compile time */
+TIMER_BIND_HANDLER(TIMER2_COMP_vect, systemTick)
+#endif
+
+/*
+ * Description :
+ * Motor callback function, called from the system tick when a door move is finished.
+ */
+void motorMoveDone(void) {
+	TRACE_POINT(TRACE_MOTOR_STOP, DcMotor_getLastResult());
+	WORK_post(eventWork, EVENT_MOTOR_DONE, WORK_PRIORITY_HIGH);
 }
 
 /*
  * Description :
- * Timer callback function that increments the global ticks variable every second.
+ * PIR callback function, called from the system tick when the area in front of the door becomes vacant.
  */
-void countOneSecond(void) {
-	/* Increment ticks every 1 second */
-	g_ticks++;
+void doorVacant(void) {
+	WORK_post(eventWork, EVENT_VACANT, WORK_PRIORITY_NORMAL);
 }
 
 /*
  * Description :
- * Function to delay for a specified time in seconds using Timer1.
+ * Start the state timer, EVENT_TIMEOUT is raised after time_ms.
  */
-void Timer1_DelaySecond(uint8 time) {
-	Timer_ConfigType timerConfig = {0, 31249, TIMER1, CLOCK_256, COMPARE_MODE};
-	Timer_setCallBack(countOneSecond, TIMER1);
-	/* Passing the configuration to initialize TIMER1 */
-	Timer_init(&timerConfig);
-	/* Wait for the specified number of seconds */
-	while (g_ticks < time);
-	/* Reset the global ticks variable */
-	g_ticks = 0;
-	/* Stop the Timer */
-	Timer_deInit(TIMER1);
+void startStateTimer(uint16 time_ms) {
+	LF_write16(&g_stateTimer, time_ms);
 }
@@ -13,6 +13,76 @@
 #include "dc_motor.h"
 #include "gpio.h"
 #include "pwm.h"
+#include "perf.h"
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+#include "encoder.h"
+#elif (MOTOR_FEEDBACK == MOTOR_FEEDBACK_LIMIT_SWITCHES)
+#include "limit_switch.h"
+#endif
+#include "adc.h"
+#include <util/atomic.h> /* To start a profile without racing the tick interrupt */
+#include "lockfree.h" /* To read the travel statistics with the interrupts enabled */
+#include "link.h"
+
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_LIMIT_SWITCHES)
+/* Limit switch closed at the end of a move to each position */
+#define MOTOR_POSITION_SWITCH(position) \
+	(((position) == MOTOR_LOCKED_POSITION) ? LIMIT_SWITCH_DOOR_CLOSED : LIMIT_SWITCH_DOOR_OPEN)
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef enum
+{
+	MOTOR_PHASE_IDLE,MOTOR_PHASE_ACCELERATE,MOTOR_PHASE_CRUISE,MOTOR_PHASE_DECELERATE,MOTOR_PHASE_TRACKING,MOTOR_PHASE_BRAKE
+}DcMotor_PhaseType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/*
+ * Motion profile state, owned by DcMotor_tick once a move is started.
+ * g_moveTime counts ms from the start of the move (from the start of the brake in the brake phase).
+ */
+static volatile DcMotor_PhaseType g_phase = MOTOR_PHASE_IDLE;
+static DcMotor_State g_direction = STOP;
+static uint16 g_duty = 0;
+static uint16 g_moveTime = 0;
+static uint8 g_stepTime = 0;
+static void (*volatile g_moveCallBackPtr)(void) = NULL_PTR;
+
+/* Result and travel time report of the moves, updated by DcMotor_tick when the brake starts */
+static DcMotor_PositionType g_targetPosition = MOTOR_UNLOCKED_POSITION;
+static volatile DcMotor_ResultType g_lastResult = MOTOR_RESULT_COMPLETED;
+static DcMotor_TravelStatsType g_travelStats[2] = {{0, 0xFFFF, 0, 0, 0}, {0, 0xFFFF, 0, 0, 0}};
+static LF_SeqlockType g_travelStatsLock = 0;
+
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+/* PID loop state, the output is signed: positive rotates in MOTOR_LOCK_DIRECTION */
+static sint16 g_targetCount = MOTOR_ENCODER_UNLOCKED_COUNT;
+static sint16 g_startCount = MOTOR_ENCODER_UNLOCKED_COUNT;
+static sint16 g_lastError = 0;
+static sint32 g_integral = 0;
+static sint16 g_output = 0;
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void DcMotor_finishMove(DcMotor_ResultType result);
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+static void DcMotor_positionLoop(void);
+#elif (MOTOR_FEEDBACK == MOTOR_FEEDBACK_LIMIT_SWITCHES)
+static void DcMotor_limitReached(LimitSwitch_IdType id);
+#endif
+#if (MOTOR_STALL_DETECTION == TRUE)
+static void DcMotor_currentSample(uint16 average);
+#endif
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
@@ -24,12 +94,25 @@
  * 2. stopping the motor at the beginning.
  */
 void DcMotor_Init(void){
+	/* Start the PWM signal once, the speed is then changed through the compare register only */
+	PWM_init();
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+	/* The door rests locked, the bolt is expected at the locked position (encoder reference) after reset */
+	ENCODER_init();
+	ENCODER_setPosition(MOTOR_ENCODER_LOCKED_COUNT);
+#elif (MOTOR_FEEDBACK == MOTOR_FEEDBACK_LIMIT_SWITCHES)
+	LIMIT_SWITCH_init();
+	LIMIT_SWITCH_setCallBack(DcMotor_limitReached);
+#endif
+#if (MOTOR_STALL_DETECTION == TRUE)
+	/* The current is only sampled while the motor is moving */
+	ADC_init();
+	ADC_setCallBack(DcMotor_currentSample);
+#endif
 	/* Configure the pins connected to IN1 and IN2 as output pins  */
-	GPIO_setupPinDirection(MOTOR_IN1_PORT_ID,MOTOR_IN1_PIN_ID,PIN_OUTPUT);
-	GPIO_setupPinDirection(MOTOR_IN2_PORT_ID,MOTOR_IN2_PIN_ID,PIN_OUTPUT);
+	GPIO_setupPortDirectionMasked(MOTOR_IN1_PORT_ID,MOTOR_PINS_MASK,PORT_OUTPUT);
 	/* Stop the motor at the beginning */
-	GPIO_writePin(MOTOR_IN1_PORT_ID,MOTOR_IN1_PIN_ID,LOGIC_LOW);
-	GPIO_writePin(MOTOR_IN2_PORT_ID,MOTOR_IN2_PIN_ID,LOGIC_LOW);
+	GPIO_writePortMasked(MOTOR_IN1_PORT_ID,MOTOR_PINS_MASK,LOGIC_LOW);
 }
 
 /*
@@ -39,20 +122,394 @@ void DcMotor_Init(void){
  * 2. adjusts the speed based on the input duty cycle.
  */
 void DcMotor_Rotate(DcMotor_State state, uint8 speed){
+	/*
+	 * IN1 and IN2 are written together in one port write, so the H-bridge never
+	 * sees an intermediate combination (e.g. both inputs high) while switching.
+	 */
 	if(state == CW){
 		/* Rotate the motor clock wise */
-		GPIO_writePin(MOTOR_IN1_PORT_ID,MOTOR_IN1_PIN_ID,LOGIC_LOW);
-		GPIO_writePin(MOTOR_IN2_PORT_ID,MOTOR_IN2_PIN_ID,LOGIC_HIGH);
+		GPIO_writePortMasked(MOTOR_IN1_PORT_ID,MOTOR_PINS_MASK,MOTOR_IN2_MASK);
 	}else if(state == ACW){
 		/* Rotate the motor anti-clock wise */
-		GPIO_writePin(MOTOR_IN1_PORT_ID,MOTOR_IN1_PIN_ID,LOGIC_HIGH);
-		GPIO_writePin(MOTOR_IN2_PORT_ID,MOTOR_IN2_PIN_ID,LOGIC_LOW);
+		GPIO_writePortMasked(MOTOR_IN1_PORT_ID,MOTOR_PINS_MASK,MOTOR_IN1_MASK);
+	}else if(state == BRAKE){
+		/* Brake the motor, both inputs high short the motor terminals through the bridge */
+		GPIO_writePortMasked(MOTOR_IN1_PORT_ID,MOTOR_PINS_MASK,MOTOR_PINS_MASK);
 	}else{
-		/* Stop the motor */
-		GPIO_writePin(MOTOR_IN1_PORT_ID,MOTOR_IN1_PIN_ID,LOGIC_LOW);
-		GPIO_writePin(MOTOR_IN2_PORT_ID,MOTOR_IN2_PIN_ID,LOGIC_LOW);
+		/* Stop the motor (coast) */
+		GPIO_writePortMasked(MOTOR_IN1_PORT_ID,MOTOR_PINS_MASK,LOGIC_LOW);
 	}
 	/* Control The DC Motor Speed using PWM */
-	PWM_START(speed);
+	PWM_setDutyPercent(speed);
+}
+
+/*
+ * Description :
+ * Function responsible for starting a move of the bolt to the required position.
+ * The function returns immediately, the move runs from DcMotor_tick and the callback
+ * (if not NULL_PTR) is called from the tick interrupt when the motor has stopped.
+ * Open loop the motion profile runs for MOTOR_PROFILE_TRAVEL_TIME_MS, with the encoder
+ * the PID loop stops the motor as soon as the target count is reached.
+ */
+void DcMotor_moveTo(DcMotor_PositionType position, void(*a_ptr)(void)){
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_targetPosition = position;
+		g_moveCallBackPtr = a_ptr;
+		g_moveTime = 0;
+		g_stepTime = 0;
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+		g_targetCount = (position == MOTOR_LOCKED_POSITION) ? MOTOR_ENCODER_LOCKED_COUNT : MOTOR_ENCODER_UNLOCKED_COUNT;
+		g_startCount = ENCODER_getPosition();
+		g_lastError = g_targetCount - g_startCount;
+		g_integral = 0;
+		g_output = 0;
+		/* The direction is chosen by the sign of the first PID output */
+		g_direction = STOP;
+		g_duty = 0;
+		g_phase = MOTOR_PHASE_TRACKING;
+		DcMotor_Rotate(STOP, 0);
+#else
+		g_direction = (position == MOTOR_LOCKED_POSITION) ? MOTOR_LOCK_DIRECTION : MOTOR_UNLOCK_DIRECTION;
+		/* Start from the first duty step instead of jumping to full speed */
+		g_duty = MOTOR_PROFILE_DUTY_STEP;
+		g_phase = MOTOR_PHASE_ACCELERATE;
+		DcMotor_Rotate(g_direction, 0);
+		PWM_setDuty(g_duty);
+#endif
+#if (MOTOR_STALL_DETECTION == TRUE)
+		ADC_startFreeRunning(MOTOR_CURRENT_ADC_CHANNEL);
+#endif
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_LIMIT_SWITCHES)
+		/* No edge will come if the bolt is already at the end position */
+		if(LIMIT_SWITCH_isClosed(MOTOR_POSITION_SWITCH(position))){
+			DcMotor_finishMove(MOTOR_RESULT_ALREADY_THERE);
+		}
+#endif
+	}
+}
+
+/*
+ * Description :
+ * Function responsible for returning TRUE while a DcMotor_moveTo profile is running.
+ */
+uint8 DcMotor_isBusy(void){
+	return (g_phase != MOTOR_PHASE_IDLE) ? TRUE : FALSE;
+}
+
+/*
+ * Description :
+ * Function responsible for running the motion profile, should be called from the
+ * 1 kHz system tick. It updates the PWM duty cycle during the ramps.
+ */
+void DcMotor_tick(void){
+	if(g_phase == MOTOR_PHASE_IDLE){
+		return;
+	}
+
+	g_moveTime++;
+	PERF_COUNT(PERF_MOTOR_RUNTIME_MS);
+
+	switch(g_phase){
+	case MOTOR_PHASE_ACCELERATE:
+		if(++g_stepTime >= MOTOR_PROFILE_STEP_MS){
+			g_stepTime = 0;
+			if(g_duty >= (MOTOR_PROFILE_MAX_DUTY - MOTOR_PROFILE_DUTY_STEP)){
+				/* Maximum speed reached, the ramp time is part of the travel time */
+				g_duty = MOTOR_PROFILE_MAX_DUTY;
+				g_phase = MOTOR_PHASE_CRUISE;
+			}else{
+				g_duty += MOTOR_PROFILE_DUTY_STEP;
+			}
+			/* Only the compare register changes during the ramp */
+			PWM_setDuty(g_duty);
+		}
+		break;
+	case MOTOR_PHASE_CRUISE:
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_LIMIT_SWITCHES)
+		/* Cruise until the limit switch interrupt ends the move */
+		if(g_moveTime >= MOTOR_PROFILE_TRAVEL_TIME_MS){
+			DcMotor_finishMove(MOTOR_RESULT_TIMEOUT);
+		}
+#else
+		/* Start the deceleration so the move ends after MOTOR_PROFILE_TRAVEL_TIME_MS */
+		if(g_moveTime >= (MOTOR_PROFILE_TRAVEL_TIME_MS - MOTOR_PROFILE_RAMP_TIME_MS)){
+			g_phase = MOTOR_PHASE_DECELERATE;
+		}
+#endif
+		break;
+	case MOTOR_PHASE_DECELERATE:
+		if(++g_stepTime >= MOTOR_PROFILE_STEP_MS){
+			g_stepTime = 0;
+			if(g_duty <= MOTOR_PROFILE_DUTY_STEP){
+				/* End of the ramp, hold the bolt with the active brake */
+				DcMotor_finishMove(MOTOR_RESULT_COMPLETED);
+			}else{
+				g_duty -= MOTOR_PROFILE_DUTY_STEP;
+				PWM_setDuty(g_duty);
+			}
+		}
+		break;
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+	case MOTOR_PHASE_TRACKING:
+		if(g_moveTime >= MOTOR_PROFILE_TRAVEL_TIME_MS){
+			/* The bolt is stuck or the encoder is not counting, don't keep driving the motor */
+			DcMotor_finishMove(MOTOR_RESULT_TIMEOUT);
+		}else if(++g_stepTime >= MOTOR_PID_PERIOD_MS){
+			g_stepTime = 0;
+			DcMotor_positionLoop();
+		}
+		break;
+#endif
+	case MOTOR_PHASE_BRAKE:
+		if(g_moveTime >= MOTOR_PROFILE_BRAKE_TIME_MS){
+			DcMotor_Rotate(STOP, 0);
+			g_phase = MOTOR_PHASE_IDLE;
+			if(g_moveCallBackPtr != NULL_PTR){
+				(*g_moveCallBackPtr)();
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Description :
+ * Function responsible for returning how the last move ended.
+ */
+DcMotor_ResultType DcMotor_getLastResult(void){
+	return g_lastResult;
+}
+
+/*
+ * Description :
+ * Function responsible for copying the lock or unlock travel time report
+ * of the required position into the given structure.
+ */
+void DcMotor_getTravelStats(DcMotor_PositionType position, DcMotor_TravelStatsType * stats_Ptr){
+	LF_seqlockRead(&g_travelStatsLock, stats_Ptr, &g_travelStats[position], sizeof(DcMotor_TravelStatsType));
+}
+
+/*
+ * Description :
+ * Function responsible for sending the travel time report of both positions over UART,
+ * one MOTOR_TRAVEL_REPORT_FRAME per position.
+ */
+void DcMotor_sendTravelStats(void){
+	DcMotor_TravelStatsType stats;
+	uint8 payload[11];
+	uint8 position;
+
+	for(position = MOTOR_UNLOCKED_POSITION; position <= MOTOR_LOCKED_POSITION; position++){
+		DcMotor_getTravelStats((DcMotor_PositionType)position, &stats);
+		payload[0] = position;
+		payload[1] = (uint8)stats.last;
+		payload[2] = (uint8)(stats.last >> 8);
+		payload[3] = (uint8)stats.min;
+		payload[4] = (uint8)(stats.min >> 8);
+		payload[5] = (uint8)stats.max;
+		payload[6] = (uint8)(stats.max >> 8);
+		payload[7] = (uint8)stats.average;
+		payload[8] = (uint8)(stats.average >> 8);
+		payload[9] = (uint8)stats.moves;
+		payload[10] = (uint8)(stats.moves >> 8);
+		LINK_sendFrame(MOTOR_TRAVEL_REPORT_FRAME, payload, sizeof(payload));
+	}
+}
+
+/*
+ * Description :
+ * Function responsible for estimating the progress of the current move: from the encoder
+ * count with MOTOR_FEEDBACK_ENCODER, otherwise from the elapsed time and the average
+ * travel time of the previous moves to the same position.
+ */
+void DcMotor_getProgress(DcMotor_ProgressType * progress_Ptr){
+	DcMotor_PhaseType phase;
+	uint16 moveTime;
+	uint16 expected;
+	uint32 percent;
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+	sint32 travel;
+	sint32 done;
+	uint32 estimate;
+#endif
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		phase = g_phase;
+		moveTime = g_moveTime;
+		expected = (g_travelStats[g_targetPosition].moves != 0) ?
+				g_travelStats[g_targetPosition].average : MOTOR_PROFILE_TRAVEL_TIME_MS;
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+		travel = (sint32)g_targetCount - g_startCount;
+		done = (sint32)ENCODER_getPosition() - g_startCount;
+#endif
+	}
+
+	if(phase == MOTOR_PHASE_IDLE){
+		progress_Ptr->percent = 100;
+		progress_Ptr->remaining_ms = 0;
+		return;
+	}
+	if(phase == MOTOR_PHASE_BRAKE){
+		progress_Ptr->percent = 100;
+		progress_Ptr->remaining_ms = (moveTime < MOTOR_PROFILE_BRAKE_TIME_MS) ? (MOTOR_PROFILE_BRAKE_TIME_MS - moveTime) : 0;
+		return;
+	}
+
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+	/* Same sign means the bolt moved towards the target */
+	percent = ((travel != 0) && ((done ^ travel) >= 0)) ? (uint32)((done * 100) / travel) : 0;
+	if(percent > 99){
+		percent = 99;
+	}
+	if(percent != 0){
+		/* Extrapolate the speed measured since the start of the move, the move can't outlast the timeout */
+		estimate = ((uint32)moveTime * 100) / percent;
+		expected = (estimate < MOTOR_PROFILE_TRAVEL_TIME_MS) ? (uint16)estimate : MOTOR_PROFILE_TRAVEL_TIME_MS;
+	}
+#else
+	percent = ((uint32)moveTime * 100) / expected;
+	if(percent > 99){
+		percent = 99;
+	}
+#endif
+	progress_Ptr->percent = (uint8)percent;
+	progress_Ptr->remaining_ms = ((expected > moveTime) ? (expected - moveTime) : 0) + MOTOR_PROFILE_BRAKE_TIME_MS;
+}
+
+/*
+ * Description :
+ * Record the travel time and the result of the current move, then start the active brake.
+ * Called from DcMotor_tick, from the ADC (stall) or limit switch interrupts, or with
+ * the interrupts disabled.
+ */
+static void DcMotor_finishMove(DcMotor_ResultType result){
+	DcMotor_TravelStatsType * stats_Ptr = &g_travelStats[g_targetPosition];
+
+	/* A move that never started has no travel time, a 0 ms entry would spoil min and average */
+	if(result != MOTOR_RESULT_ALREADY_THERE){
+		LF_seqlockWriteBegin(&g_travelStatsLock);
+		stats_Ptr->last = g_moveTime;
+		if(g_moveTime < stats_Ptr->min){
+			stats_Ptr->min = g_moveTime;
+		}
+		if(g_moveTime > stats_Ptr->max){
+			stats_Ptr->max = g_moveTime;
+		}
+		if(stats_Ptr->moves == 0){
+			stats_Ptr->average = g_moveTime;
+		}else{
+			stats_Ptr->average = (uint16)(stats_Ptr->average + (((sint32)g_moveTime - stats_Ptr->average) >> 3));
+		}
+		stats_Ptr->moves++;
+		LF_seqlockWriteEnd(&g_travelStatsLock);
+	}
+	g_lastResult = result;
+
+#if (MOTOR_STALL_DETECTION == TRUE)
+	ADC_stop();
+#endif
+
+	/* Hold the bolt with the active brake, g_moveTime now counts the brake time */
+	g_duty = 0;
+	g_moveTime = 0;
+	g_phase = MOTOR_PHASE_BRAKE;
+	DcMotor_Rotate(BRAKE, 100);
+}
+
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+/*
+ * Description :
+ * One step of the fixed-point PID position loop, called every MOTOR_PID_PERIOD_MS.
+ * The motor is braked as soon as the encoder is within MOTOR_ENCODER_TOLERANCE of the target.
+ */
+static void DcMotor_positionLoop(void){
+	sint16 error = g_targetCount - ENCODER_getPosition();
+	sint32 output;
+	DcMotor_State direction;
+
+	if((error <= MOTOR_ENCODER_TOLERANCE) && (error >= -MOTOR_ENCODER_TOLERANCE)){
+		DcMotor_finishMove(MOTOR_RESULT_POSITION_REACHED);
+		return;
+	}
+
+	/* Integral with anti-windup clamp */
+	g_integral += error;
+	if(g_integral > MOTOR_PID_INTEGRAL_LIMIT){
+		g_integral = MOTOR_PID_INTEGRAL_LIMIT;
+	}else if(g_integral < -MOTOR_PID_INTEGRAL_LIMIT){
+		g_integral = -MOTOR_PID_INTEGRAL_LIMIT;
+	}
+
+	output = ((sint32)MOTOR_PID_KP * error
+			+ (sint32)MOTOR_PID_KI * g_integral
+			+ (sint32)MOTOR_PID_KD * (error - g_lastError)) >> MOTOR_PID_SHIFT;
+	g_lastError = error;
+
+	/* Limit the duty change per period so the motor still ramps up and down smoothly */
+	if(output > (g_output + MOTOR_PID_DUTY_SLEW)){
+		output = g_output + MOTOR_PID_DUTY_SLEW;
+	}else if(output < (g_output - MOTOR_PID_DUTY_SLEW)){
+		output = g_output - MOTOR_PID_DUTY_SLEW;
+	}
+	if(output > MOTOR_PROFILE_MAX_DUTY){
+		output = MOTOR_PROFILE_MAX_DUTY;
+	}else if(output < -(sint32)MOTOR_PROFILE_MAX_DUTY){
+		output = -(sint32)MOTOR_PROFILE_MAX_DUTY;
+	}
+	g_output = (sint16)output;
+
+	/* Rewrite the bridge inputs only when the sign of the output changes */
+	if(g_output > 0){
+		direction = MOTOR_LOCK_DIRECTION;
+		g_duty = (uint16)g_output;
+	}else if(g_output < 0){
+		direction = MOTOR_UNLOCK_DIRECTION;
+		g_duty = (uint16)(-g_output);
+	}else{
+		direction = STOP;
+		g_duty = 0;
+	}
+	if(direction != g_direction){
+		g_direction = direction;
+		DcMotor_Rotate(direction, 0);
+	}
+	PWM_setDuty(g_duty);
 }
+#endif
 
+#if (MOTOR_STALL_DETECTION == TRUE)
+/*
+ * Description :
+ * ADC callback, called from the ADC interrupt with the average motor current of the last
+ * ADC_BUFFER_SIZE samples. Cuts the motor the moment the current reaches the stall threshold.
+ */
+static void DcMotor_currentSample(uint16 average){
+	if((g_phase == MOTOR_PHASE_IDLE) || (g_phase == MOTOR_PHASE_BRAKE)){
+		return;
+	}
+	/* Ignore the inrush current while the motor starts */
+	if((g_moveTime >= MOTOR_STALL_BLANKING_MS) && (average >= MOTOR_STALL_THRESHOLD)){
+		DcMotor_finishMove(MOTOR_RESULT_STALLED);
+	}
+}
+#endif
+
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_LIMIT_SWITCHES)
+/*
+ * Description :
+ * Limit switch callback, called from INT0/INT1 when a switch closes.
+ * Stops the motor the instant the bolt reaches the switch of the target position.
+ */
+static void DcMotor_limitReached(LimitSwitch_IdType id){
+	if((g_phase == MOTOR_PHASE_IDLE) || (g_phase == MOTOR_PHASE_BRAKE)){
+		return;
+	}
+	if(id == MOTOR_POSITION_SWITCH(g_targetPosition)){
+		DcMotor_finishMove(MOTOR_RESULT_POSITION_REACHED);
+	}
+}
+#endif
@@ -14,8 +14,9 @@
 #define MOTOR_H_
 
 #include "std_types.h"
-
-#define PWM_START(SPEED)	PWM_Timer0_Start(SPEED)
+#include "gpio.h" /* For the port and pin IDs used in the configuration checks */
+#include "pwm.h" /* For PWM_DUTY_MAX used by the motion profile */
+#include "adc.h" /* For the current sensing thresholds */
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -27,8 +28,140 @@
 #define MOTOR_IN2_PORT_ID			PORTD_ID
 #define MOTOR_IN2_PIN_ID			PIN7_ID
 
+/* The enable pin is the PWM output: OC0 (PB3) with the Timer0 backend, OC1A (PD5) / OC1B (PD4) with Timer1 */
+#if (PWM_BACKEND == PWM_BACKEND_TIMER0)
 #define MOTOR_ENABLE1_PORT_ID		PORTB_ID
 #define MOTOR_ENABLE_PIN_ID			PIN3_ID
+#elif (PWM_TIMER1_CHANNEL == PWM_TIMER1_OC1A)
+#define MOTOR_ENABLE1_PORT_ID		PORTD_ID
+#define MOTOR_ENABLE_PIN_ID			PIN5_ID
+#else
+#define MOTOR_ENABLE1_PORT_ID		PORTD_ID
+#define MOTOR_ENABLE_PIN_ID			PIN4_ID
+#endif
+
+/* IN1 and IN2 are updated together with one masked port write, so they must share a port */
+#if (MOTOR_IN1_PORT_ID != MOTOR_IN2_PORT_ID)
+#error "MOTOR_IN1 and MOTOR_IN2 should be connected to the same port"
+#endif
+
+#define MOTOR_IN1_MASK				(1 << MOTOR_IN1_PIN_ID)
+#define MOTOR_IN2_MASK				(1 << MOTOR_IN2_PIN_ID)
+#define MOTOR_PINS_MASK				(MOTOR_IN1_MASK | MOTOR_IN2_MASK)
+
+/* Rotation direction that moves the bolt to each end position */
+#define MOTOR_UNLOCK_DIRECTION		ACW
+#define MOTOR_LOCK_DIRECTION		CW
+
+/*
+ * Trapezoidal motion profile used by DcMotor_moveTo, all times are in ms (system ticks):
+ * the speed ramps up from 0 to MOTOR_PROFILE_MAX_SPEED in MOTOR_PROFILE_RAMP_TIME_MS,
+ * cruises, ramps down again so that the whole move takes MOTOR_PROFILE_TRAVEL_TIME_MS,
+ * then the motor is actively braked for MOTOR_PROFILE_BRAKE_TIME_MS.
+ */
+#define MOTOR_PROFILE_MAX_SPEED			100   /* Cruise duty cycle in percent */
+#define MOTOR_PROFILE_RAMP_TIME_MS		500
+#define MOTOR_PROFILE_TRAVEL_TIME_MS	15000
+#define MOTOR_PROFILE_BRAKE_TIME_MS		200
+#define MOTOR_PROFILE_STEP_MS			2     /* Duty cycle update period during the ramps */
+
+/* Cruise duty and duty change applied every MOTOR_PROFILE_STEP_MS, in PWM compare counts */
+#define MOTOR_PROFILE_MAX_DUTY			((PWM_DUTY_MAX * MOTOR_PROFILE_MAX_SPEED) / 100)
+#define MOTOR_PROFILE_DUTY_STEP			((MOTOR_PROFILE_MAX_DUTY * MOTOR_PROFILE_STEP_MS) / MOTOR_PROFILE_RAMP_TIME_MS)
+
+#if (MOTOR_PROFILE_DUTY_STEP == 0)
+#error "MOTOR_PROFILE_RAMP_TIME_MS is too long for MOTOR_PROFILE_STEP_MS, the duty step is zero"
+#endif
+
+#if (MOTOR_PROFILE_TRAVEL_TIME_MS < (2 * MOTOR_PROFILE_RAMP_TIME_MS))
+#error "MOTOR_PROFILE_TRAVEL_TIME_MS should be long enough for both ramps"
+#endif
+
+/*
+ * Position feedback used by DcMotor_moveTo:
+ * MOTOR_FEEDBACK_NONE    : open loop, the move takes MOTOR_PROFILE_TRAVEL_TIME_MS.
+ * MOTOR_FEEDBACK_ENCODER : closed loop on the quadrature encoder, the move ends as soon as
+ *                          the bolt reaches the target, MOTOR_PROFILE_TRAVEL_TIME_MS is the timeout.
+ * MOTOR_FEEDBACK_LIMIT_SWITCHES : the ramp profile runs until the door-open/door-closed switch
+ *                          closes, MOTOR_PROFILE_TRAVEL_TIME_MS is the timeout.
+ * The encoder and the limit switches both use INT0/INT1, so only one of them can be selected.
+ * The current board has neither, the default is open loop: define MOTOR_FEEDBACK in the build
+ * options to use the encoder (A on INT0/PD2, B on INT1/PD3) or the limit switches.
+ */
+#define MOTOR_FEEDBACK_NONE				0
+#define MOTOR_FEEDBACK_ENCODER			1
+#define MOTOR_FEEDBACK_LIMIT_SWITCHES	2
+
+#ifndef MOTOR_FEEDBACK
+#define MOTOR_FEEDBACK					MOTOR_FEEDBACK_NONE
+#endif
+
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+
+/*
+ * Encoder counts of both end positions, the count increases in MOTOR_LOCK_DIRECTION.
+ * The door rests locked: DcMotor_Init references the encoder at MOTOR_ENCODER_LOCKED_COUNT.
+ */
+#define MOTOR_ENCODER_UNLOCKED_COUNT	0
+#define MOTOR_ENCODER_LOCKED_COUNT		1200
+#define MOTOR_ENCODER_TOLERANCE			4     /* Target reached within +/- counts */
+
+/*
+ * Fixed-point PID position loop, run every MOTOR_PID_PERIOD_MS:
+ * duty = (KP * error + KI * sum(error) + KD * delta(error)) >> MOTOR_PID_SHIFT
+ * with the error in encoder counts and the duty in PWM compare counts.
+ * The gains are Q8 (256 = 1.0).
+ */
+#define MOTOR_PID_PERIOD_MS				5
+#define MOTOR_PID_SHIFT					8
+#define MOTOR_PID_KP					640   /* 2.5 */
+#define MOTOR_PID_KI					4     /* 0.016 */
+#define MOTOR_PID_KD					2048  /* 8.0 */
+
+/* Anti-windup: the integral term alone never exceeds the cruise duty */
+#define MOTOR_PID_INTEGRAL_LIMIT		(((sint32)MOTOR_PROFILE_MAX_DUTY << MOTOR_PID_SHIFT) / MOTOR_PID_KI)
+
+/* Duty change allowed per PID period, keeps the acceleration of the ramp profile */
+#define MOTOR_PID_DUTY_SLEW				((MOTOR_PROFILE_DUTY_STEP * MOTOR_PID_PERIOD_MS) / MOTOR_PROFILE_STEP_MS)
+
+#if (MOTOR_PID_PERIOD_MS < MOTOR_PROFILE_STEP_MS)
+#error "MOTOR_PID_PERIOD_MS should not be shorter than MOTOR_PROFILE_STEP_MS"
+#endif
+
+#endif
+
+/*
+ * Stall / end of travel detection on the motor current: the H-bridge current flows through
+ * a shunt resistor sampled by the free running ADC. The move is ended as soon as the average
+ * current exceeds MOTOR_STALL_CURRENT_MA, except during the start-up inrush (blanking time).
+ * The current board has no shunt, so it is disabled by default. To enable it, put a
+ * MOTOR_SHUNT_MILLIOHM resistor between the H-bridge ground (sense) pin and GND, connect
+ * the bridge side of the resistor to ADC0 (PA0), with AVCC connected, and define
+ * MOTOR_STALL_DETECTION as TRUE. While a move runs the ADC interrupts at ~9.6 kHz.
+ */
+#ifndef MOTOR_STALL_DETECTION
+#define MOTOR_STALL_DETECTION			FALSE
+#endif
+
+#if (MOTOR_STALL_DETECTION == TRUE)
+
+#define MOTOR_CURRENT_ADC_CHANNEL		0     /* ADC0 (PA0) */
+#define MOTOR_SHUNT_MILLIOHM			500
+#define MOTOR_STALL_CURRENT_MA			800
+#define MOTOR_STALL_BLANKING_MS			100
+
+/* Stall current threshold in ADC counts */
+#define MOTOR_STALL_THRESHOLD			ADC_MV_TO_COUNTS(((uint32)MOTOR_STALL_CURRENT_MA * MOTOR_SHUNT_MILLIOHM) / 1000)
+
+#if (((MOTOR_STALL_CURRENT_MA * MOTOR_SHUNT_MILLIOHM) / 1000) >= ADC_REF_VOLT_MV)
+#error "The shunt voltage at MOTOR_STALL_CURRENT_MA is above the ADC reference"
+#endif
+
+#endif
+
+/* Link frames of the travel time report (0x21 is LINK_FRAME_START) */
+#define MOTOR_TRAVEL_QUERY_FRAME		0x22 /* Request, no payload */
+#define MOTOR_TRAVEL_REPORT_FRAME		0x23 /* Position, last, min, max and average travel time in ms, moves (2 bytes each) */
 
 
 /*******************************************************************************
@@ -37,9 +170,45 @@
 
 typedef enum
 {
-	STOP,CW,ACW
+	STOP,CW,ACW,BRAKE
 }DcMotor_State;
 
+typedef enum
+{
+	MOTOR_UNLOCKED_POSITION,MOTOR_LOCKED_POSITION
+}DcMotor_PositionType;
+
+typedef enum
+{
+	MOTOR_RESULT_COMPLETED,        /* Open loop profile finished */
+	MOTOR_RESULT_POSITION_REACHED, /* Encoder target reached or limit switch closed */
+	MOTOR_RESULT_TIMEOUT,          /* Target not reached within MOTOR_PROFILE_TRAVEL_TIME_MS */
+	MOTOR_RESULT_STALLED,          /* Current limit reached (end stop or jammed bolt) */
+	MOTOR_RESULT_ALREADY_THERE     /* Limit switch already closed, the motor did not run */
+}DcMotor_ResultType;
+
+/*
+ * Travel times in ms of the moves to one position, the brake time is not included.
+ * A move that finds the bolt already at the position (MOTOR_RESULT_ALREADY_THERE) is not counted.
+ * average follows the recent moves (1/8 weight per move), a rising value shows a door
+ * getting slower mechanically.
+ */
+typedef struct
+{
+	uint16 last;
+	uint16 min;
+	uint16 max;
+	uint16 average;
+	uint16 moves;
+}DcMotor_TravelStatsType;
+
+/* Progress of the current move, used for the door status reported to HMI_ECU */
+typedef struct
+{
+	uint8 percent;       /* 0..100, 100 when the bolt is at the end position */
+	uint16 remaining_ms; /* Estimated time until the motor stops (brake included) */
+}DcMotor_ProgressType;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -60,4 +229,55 @@ void DcMotor_Init(void);
  */
 void DcMotor_Rotate(DcMotor_State state, uint8 speed);
 
+/*
+ * Description :
+ * Function responsible for starting a move of the bolt to the required position.
+ * The function returns immediately, the move runs from DcMotor_tick and the callback
+ * (if not NULL_PTR) is called from the tick interrupt when the motor has stopped.
+ * Open loop the motion profile runs for MOTOR_PROFILE_TRAVEL_TIME_MS, with the encoder
+ * the PID loop stops the motor as soon as the target count is reached.
+ */
+void DcMotor_moveTo(DcMotor_PositionType position, void(*a_ptr)(void));
+
+/*
+ * Description :
+ * Function responsible for returning TRUE while a DcMotor_moveTo profile is running.
+ */
+uint8 DcMotor_isBusy(void);
+
+/*
+ * Description :
+ * Function responsible for running the motion profile, should be called from the
+ * 1 kHz system tick. It updates the PWM duty cycle during the ramps.
+ */
+void DcMotor_tick(void);
+
+/*
+ * Description :
+ * Function responsible for returning how the last move ended.
+ */
+DcMotor_ResultType DcMotor_getLastResult(void);
+
+/*
+ * Description :
+ * Function responsible for copying the lock or unlock travel time report
+ * of the required position into the given structure.
+ */
+void DcMotor_getTravelStats(DcMotor_PositionType position, DcMotor_TravelStatsType * stats_Ptr);
+
+/*
+ * Description :
+ * Function responsible for sending the travel time report of both positions over UART,
+ * one MOTOR_TRAVEL_REPORT_FRAME per position.
+ */
+void DcMotor_sendTravelStats(void);
+
+/*
+ * Description :
+ * Function responsible for estimating the progress of the current move: from the encoder
+ * count with MOTOR_FEEDBACK_ENCODER, otherwise from the elapsed time and the average
+ * travel time of the previous moves to the same position.
+ */
+void DcMotor_getProgress(DcMotor_ProgressType * progress_Ptr);
+
 #endif /* MOTOR_H_ */
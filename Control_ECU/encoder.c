@@ -0,0 +1,135 @@
+/******************************************************************************
+ *
+ * Module: Encoder
+ *
+ * File Name: encoder.c
+ *
+ * Description: Source file for the quadrature encoder driver (external interrupts)
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "encoder.h"
+#include "dc_motor.h" /* For MOTOR_FEEDBACK */
+#include "gpio.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h> /* To read the 16-bit position without tearing */
+
+/* INT0/INT1 are shared with the limit switch driver, only the driver selected by MOTOR_FEEDBACK is built */
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_ENCODER)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static volatile sint16 g_position = 0;
+static volatile uint8 g_lastState = 0;
+
+/*
+ * Position change for each (previous state, new state) pair, indexed by
+ * (previous << 2) | new where a state is (A << 1) | B.
+ * Invalid transitions (both channels changed) are ignored.
+ */
+static const sint8 g_quadratureTable[16] = {
+	 0, -1,  1,  0,
+	 1,  0,  0, -1,
+	-1,  0,  0,  1,
+	 0,  1, -1,  0
+};
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read both channels and return the state as (A << 1) | B.
+ */
+static uint8 ENCODER_readState(void)
+{
+	return (uint8)((GPIO_readPinFast(ENCODER_A_PORT_ID, ENCODER_A_PIN_ID) << 1) | GPIO_readPinFast(ENCODER_B_PORT_ID, ENCODER_B_PIN_ID));
+}
+
+/*
+ * Description :
+ * Setup the encoder pins as inputs with pull-ups, reset the position to zero
+ * and enable INT0/INT1 on any logical change.
+ */
+void ENCODER_init(void)
+{
+	GPIO_setupPinDirectionFast(ENCODER_A_PORT_ID, ENCODER_A_PIN_ID, PIN_INPUT);
+	GPIO_setupPinDirectionFast(ENCODER_B_PORT_ID, ENCODER_B_PIN_ID, PIN_INPUT);
+	/* Enable the internal pull-up resistors for open collector encoders */
+	GPIO_writePinFast(ENCODER_A_PORT_ID, ENCODER_A_PIN_ID, LOGIC_HIGH);
+	GPIO_writePinFast(ENCODER_B_PORT_ID, ENCODER_B_PIN_ID, LOGIC_HIGH);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_position = 0;
+		g_lastState = ENCODER_readState();
+
+		/* INT0 and INT1 on any logical change: ISC00 = 1, ISC10 = 1 */
+		MCUCR = (MCUCR & ~((1 << ISC01) | (1 << ISC11))) | (1 << ISC00) | (1 << ISC10);
+		/* Clear any pending flag then enable both interrupts */
+		GIFR = (1 << INTF0) | (1 << INTF1);
+		GICR |= (1 << INT0) | (1 << INT1);
+	}
+}
+
+/*
+ * Description :
+ * Return the current position in encoder counts (read atomically).
+ */
+sint16 ENCODER_getPosition(void)
+{
+	sint16 position;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		position = g_position;
+	}
+
+	return position;
+}
+
+/*
+ * Description :
+ * Set the current position, used to re-reference the encoder at a known position.
+ */
+void ENCODER_setPosition(sint16 position)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_position = position;
+	}
+}
+
+/*******************************************************************************
+ *                      Interrupt Service Routines                             *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Decode one edge of channel A or B.
+ */
+static void ENCODER_decode(void)
+{
+	uint8 state = ENCODER_readState();
+
+	g_position += g_quadratureTable[(g_lastState << 2) | state];
+	g_lastState = state;
+}
+
+ISR(INT0_vect)
+{
+	ENCODER_decode();
+}
+
+ISR(INT1_vect)
+{
+	ENCODER_decode();
+}
+
+#endif
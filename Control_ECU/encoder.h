@@ -0,0 +1,56 @@
+/******************************************************************************
+ *
+ * Module: Encoder
+ *
+ * File Name: encoder.h
+ *
+ * Description: Header file for the quadrature encoder driver (external interrupts)
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef ENCODER_H_
+#define ENCODER_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Channel A is connected to INT0 (PD2) and channel B to INT1 (PD3). Both interrupts
+ * fire on any logical change, so every edge of both channels is decoded (x4 resolution).
+ * The position counts up while the bolt moves towards the locked position.
+ */
+#define ENCODER_A_PORT_ID             PORTD_ID
+#define ENCODER_A_PIN_ID              PIN2_ID
+
+#define ENCODER_B_PORT_ID             PORTD_ID
+#define ENCODER_B_PIN_ID              PIN3_ID
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Setup the encoder pins as inputs with pull-ups, reset the position to zero
+ * and enable INT0/INT1 on any logical change.
+ */
+void ENCODER_init(void);
+
+/*
+ * Description :
+ * Return the current position in encoder counts (read atomically).
+ */
+sint16 ENCODER_getPosition(void);
+
+/*
+ * Description :
+ * Set the current position, used to re-reference the encoder at a known position.
+ */
+void ENCODER_setPosition(sint16 position);
+
+#endif /* ENCODER_H_ */
@@ -13,18 +13,38 @@
 
 #include "external_eeprom.h"
 #include "twi.h"
+#include "perf.h"
+#include <util/delay.h>
+
+// Send a start and the EEPROM device address (write operation), retried while a write cycle is running
+static uint8 EEPROM_start(uint16 u16addr)
+{
+    uint8 retries = 0;
+
+    for (;;) {
+        TWI_start();
+        if (TWI_getStatus() != TWI_START)
+            return ERROR;
+
+        TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700) >> 7)));
+        if (TWI_getStatus() == TWI_MT_SLA_W_ACK)
+            return SUCCESS;
+
+        // Address not acknowledged: release the bus and try again later
+        TWI_stop();
+        if (retries >= EEPROM_MAX_RETRIES)
+            return ERROR;
+        retries++;
+        PERF_COUNT(PERF_EEPROM_RETRIES);
+        _delay_us(EEPROM_RETRY_DELAY_US);
+    }
+}
 
 // Function to write a single byte to EEPROM
 uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
 {
-    // Start the TWI communication
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-
-    // Send the EEPROM device address (write operation)
-    TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700) >> 7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
+    // Start the TWI communication with the EEPROM device (write operation)
+    if (EEPROM_start(u16addr) != SUCCESS)
         return ERROR;
 
     // Send the memory address (lower 8 bits)
@@ -46,14 +66,8 @@ uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
 // Function to read a single byte from EEPROM
 uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
 {
-    // Start the TWI communication
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-
-    // Send the EEPROM device address (write operation)
-    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700) >> 7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
+    // Start the TWI communication with the EEPROM device (write operation)
+    if (EEPROM_start(u16addr) != SUCCESS)
         return ERROR;
 
     // Send the memory address (lower 8 bits)
@@ -87,14 +101,8 @@ uint8 EEPROM_writeData(uint16 u16addr, uint8 *u8data, uint8 size)
 {
     uint8 i;
 
-    // Start the TWI communication
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-
-    // Send the EEPROM device address (write operation)
-    TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700) >> 7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
+    // Start the TWI communication with the EEPROM device (write operation)
+    if (EEPROM_start(u16addr) != SUCCESS)
         return ERROR;
 
     // Send the memory address (lower 8 bits)
@@ -120,14 +128,8 @@ uint8 EEPROM_readData(uint16 u16addr, uint8 *u8data, uint8 size)
 {
     uint8 i;
 
-    // Start the TWI communication
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-
-    // Send the EEPROM device address (write operation)
-    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700) >> 7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
+    // Start the TWI communication with the EEPROM device (write operation)
+    if (EEPROM_start(u16addr) != SUCCESS)
         return ERROR;
 
     // Send the memory address (lower 8 bits)
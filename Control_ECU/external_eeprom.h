@@ -22,6 +22,13 @@
 #define ERROR 0
 #define SUCCESS 1
 
+/*
+ * The EEPROM does not acknowledge its address during a write cycle (up to 5 ms),
+ * the transfer is restarted every EEPROM_RETRY_DELAY_US up to EEPROM_MAX_RETRIES times.
+ */
+#define EEPROM_MAX_RETRIES       20
+#define EEPROM_RETRY_DELAY_US    500
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
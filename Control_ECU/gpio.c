@@ -12,6 +12,7 @@
 #include "gpio.h"
 #include "common_macros.h" /* To use the macros like SET_BIT */
 #include "avr/io.h" /* To use the IO Ports Registers */
+#include <util/atomic.h> /* To use ATOMIC_BLOCK for the masked read-modify-write */
 
 /*
  * Description :
@@ -328,3 +329,101 @@ uint8 GPIO_readPort(uint8 port_num)
 
 	return value;
 }
+
+/*
+ * Description :
+ * Setup the direction of the pins selected by mask in the required port in one step.
+ * Each bit in direction is the new direction of the same pin (1 = output, 0 = input),
+ * so PORT_OUTPUT/PORT_INPUT can be passed to make all the masked pins output/input.
+ * Pins outside the mask keep their direction. The update is atomic with respect to interrupts.
+ * If the input port number is not correct, The function will not handle the request.
+ */
+void GPIO_setupPortDirectionMasked(uint8 port_num, uint8 mask, uint8 direction)
+{
+	/*
+	 * Check if the input number is greater than NUM_OF_PORTS value.
+	 * In this case the input is not valid port number
+	 */
+	if(port_num >= NUM_OF_PORTS)
+	{
+		/* Do Nothing */
+	}
+	else
+	{
+		/*
+		 * The read-modify-write is done with interrupts disabled so an ISR changing
+		 * another pin of the same port can not be lost between the read and the write.
+		 */
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			switch(port_num)
+			{
+			case PORTA_ID:
+				DDRA = (DDRA & ~mask) | (direction & mask);
+				break;
+			case PORTB_ID:
+				DDRB = (DDRB & ~mask) | (direction & mask);
+				break;
+			case PORTC_ID:
+				DDRC = (DDRC & ~mask) | (direction & mask);
+				break;
+			case PORTD_ID:
+				DDRD = (DDRD & ~mask) | (direction & mask);
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * Description :
+ * Write the value bits on the pins selected by mask in the required port in one step.
+ * All the masked pins change at the same time, pins outside the mask keep their value.
+ * The update is atomic with respect to interrupts.
+ * If the input port number is not correct, The function will not handle the request.
+ */
+void GPIO_writePortMasked(uint8 port_num, uint8 mask, uint8 value)
+{
+	/*
+	 * Check if the input number is greater than NUM_OF_PORTS value.
+	 * In this case the input is not valid port number
+	 */
+	if(port_num >= NUM_OF_PORTS)
+	{
+		/* Do Nothing */
+	}
+	else
+	{
+		/* Single OUT to the port register, so no intermediate pin combination is visible */
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			switch(port_num)
+			{
+			case PORTA_ID:
+				PORTA = (PORTA & ~mask) | (value & mask);
+				break;
+			case PORTB_ID:
+				PORTB = (PORTB & ~mask) | (value & mask);
+				break;
+			case PORTC_ID:
+				PORTC = (PORTC & ~mask) | (value & mask);
+				break;
+			case PORTD_ID:
+				PORTD = (PORTD & ~mask) | (value & mask);
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * Description :
+ * Read and return the value of the pins selected by mask in the required port.
+ * Pins outside the mask are returned as zero.
+ * If the input port number is not correct, The function will return ZERO value.
+ */
+uint8 GPIO_readPortMasked(uint8 port_num, uint8 mask)
+{
+	/* One read of the PIN register samples all the masked pins at the same instant */
+	return GPIO_readPort(port_num) & mask;
+}
@@ -0,0 +1,120 @@
+/******************************************************************************
+ *
+ * Module: Latency Histogram
+ *
+ * File Name: histogram.c
+ *
+ * Description: Source file for the latency histograms
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "histogram.h"
+#include "link.h"
+#include <util/atomic.h> /* Samples may be recorded from the ISRs */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef struct
+{
+	uint32 samples;
+	uint32 max_us;
+	uint16 buckets[HIST_BUCKETS];
+}HIST_DataType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static HIST_DataType g_histograms[HIST_COUNT];
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add a sample to a histogram. Fixed time and memory, the bucket counts saturate
+ * at 65535 instead of wrapping.
+ */
+void HIST_record(uint8 id, uint32 time_us)
+{
+	uint32 value = time_us >> HIST_BASE_SHIFT;
+	uint8 bucket = 0;
+
+	/* Bucket = number of significant bits, at most 32 - HIST_BASE_SHIFT iterations */
+	while((value != 0) && (bucket < (HIST_BUCKETS - 1)))
+	{
+		value >>= 1;
+		bucket++;
+	}
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		HIST_DataType *hist_Ptr = &g_histograms[id];
+
+		hist_Ptr->samples++;
+		if(time_us > hist_Ptr->max_us)
+		{
+			hist_Ptr->max_us = time_us;
+		}
+		if(hist_Ptr->buckets[bucket] != 0xFFFF)
+		{
+			hist_Ptr->buckets[bucket]++;
+		}
+	}
+}
+
+/*
+ * Description :
+ * Send all the histograms over UART: a HIST_SUMMARY_FRAME then the HIST_BUCKETS_FRAME
+ * frames of each histogram.
+ */
+void HIST_send(void)
+{
+	HIST_DataType hist;
+	uint8 payload[2 + (2 * HIST_BUCKETS_PER_FRAME)];
+	uint8 id;
+	uint8 bucket;
+	uint8 length;
+
+	for(id = 0; id < HIST_COUNT; id++)
+	{
+		/* Consistent copy, the UART transmission runs with the interrupts enabled */
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			hist = g_histograms[id];
+		}
+
+		payload[0] = id;
+		payload[1] = (uint8)hist.samples;
+		payload[2] = (uint8)(hist.samples >> 8);
+		payload[3] = (uint8)(hist.samples >> 16);
+		payload[4] = (uint8)(hist.samples >> 24);
+		payload[5] = (uint8)hist.max_us;
+		payload[6] = (uint8)(hist.max_us >> 8);
+		payload[7] = (uint8)(hist.max_us >> 16);
+		payload[8] = (uint8)(hist.max_us >> 24);
+		payload[9] = HIST_BASE_SHIFT;
+		payload[10] = HIST_BUCKETS;
+		LINK_sendFrame(HIST_SUMMARY_FRAME, payload, 11);
+
+		bucket = 0;
+		while(bucket < HIST_BUCKETS)
+		{
+			payload[0] = id;
+			payload[1] = bucket;
+			length = 2;
+			while((bucket < HIST_BUCKETS) && (length < sizeof(payload)))
+			{
+				payload[length++] = (uint8)hist.buckets[bucket];
+				payload[length++] = (uint8)(hist.buckets[bucket] >> 8);
+				bucket++;
+			}
+			LINK_sendFrame(HIST_BUCKETS_FRAME, payload, length);
+		}
+	}
+}
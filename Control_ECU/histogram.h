@@ -0,0 +1,64 @@
+/******************************************************************************
+ *
+ * Module: Latency Histogram
+ *
+ * File Name: histogram.h
+ *
+ * Description: Header file for the latency histograms
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Logarithmic buckets: bucket 0 counts the samples below HIST_BASE_US, bucket n
+ * the samples in [HIST_BASE_US << (n - 1), HIST_BASE_US << n), the last bucket
+ * also counts everything above. 64 us << 19 = 33.5 s covers a whole unlock move.
+ */
+#define HIST_BASE_SHIFT               6    /* HIST_BASE_US = 64 us */
+#define HIST_BUCKETS                  21
+
+/* Histogram IDs */
+#define HIST_VERIFY                   0    /* Password received to verdict sent */
+#define HIST_EEPROM                   1    /* One EEPROM password read or write */
+#define HIST_UNLOCK                   2    /* Unlock command received to bolt unlocked */
+#define HIST_COUNT                    3
+
+/* Link frames of the histograms export */
+#define HIST_QUERY_FRAME              0x15 /* Request, no payload */
+#define HIST_SUMMARY_FRAME            0x16 /* ID, samples (4 bytes), max in us (4 bytes), HIST_BASE_SHIFT, HIST_BUCKETS */
+#define HIST_BUCKETS_FRAME            0x17 /* ID, first bucket, up to HIST_BUCKETS_PER_FRAME buckets */
+#define HIST_BUCKETS_PER_FRAME        7    /* 2 bytes each, little endian */
+
+#if (HIST_BUCKETS > 32 - HIST_BASE_SHIFT + 1)
+#error "HIST_BUCKETS is larger than the range of a 32-bit time in us"
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add a sample to a histogram. Fixed time and memory, the bucket counts saturate
+ * at 65535 instead of wrapping.
+ */
+void HIST_record(uint8 id, uint32 time_us);
+
+/*
+ * Description :
+ * Send all the histograms over UART: a HIST_SUMMARY_FRAME then the HIST_BUCKETS_FRAME
+ * frames of each histogram.
+ */
+void HIST_send(void);
+
+#endif /* HISTOGRAM_H_ */
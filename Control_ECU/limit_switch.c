@@ -0,0 +1,104 @@
+/******************************************************************************
+ *
+ * Module: Limit Switch
+ *
+ * File Name: limit_switch.c
+ *
+ * Description: Source file for the door limit switches driver (external interrupts)
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "limit_switch.h"
+#include "dc_motor.h" /* For MOTOR_FEEDBACK */
+#include "gpio.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+/* INT0/INT1 are shared with the encoder driver, only the driver selected by MOTOR_FEEDBACK is built */
+#if (MOTOR_FEEDBACK == MOTOR_FEEDBACK_LIMIT_SWITCHES)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static void (*volatile g_limitSwitchCallBackPtr)(LimitSwitch_IdType id) = NULL_PTR;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Setup the switch pins as inputs with pull-ups and enable INT0/INT1 on the falling edge.
+ */
+void LIMIT_SWITCH_init(void)
+{
+	GPIO_setupPinDirectionFast(LIMIT_SWITCH_CLOSED_PORT_ID, LIMIT_SWITCH_CLOSED_PIN_ID, PIN_INPUT);
+	GPIO_setupPinDirectionFast(LIMIT_SWITCH_OPEN_PORT_ID, LIMIT_SWITCH_OPEN_PIN_ID, PIN_INPUT);
+	/* Enable the internal pull-up resistors */
+	GPIO_writePinFast(LIMIT_SWITCH_CLOSED_PORT_ID, LIMIT_SWITCH_CLOSED_PIN_ID, LOGIC_HIGH);
+	GPIO_writePinFast(LIMIT_SWITCH_OPEN_PORT_ID, LIMIT_SWITCH_OPEN_PIN_ID, LOGIC_HIGH);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		/* INT0 and INT1 on the falling edge: ISCx1 = 1, ISCx0 = 0 */
+		MCUCR = (MCUCR & ~((1 << ISC00) | (1 << ISC10))) | (1 << ISC01) | (1 << ISC11);
+		/* Clear any pending flag then enable both interrupts */
+		GIFR = (1 << INTF0) | (1 << INTF1);
+		GICR |= (1 << INT0) | (1 << INT1);
+	}
+}
+
+/*
+ * Description :
+ * Return TRUE if the required switch is closed (the bolt is at this end position).
+ */
+uint8 LIMIT_SWITCH_isClosed(LimitSwitch_IdType id)
+{
+	if(id == LIMIT_SWITCH_DOOR_CLOSED)
+	{
+		return (GPIO_readPinFast(LIMIT_SWITCH_CLOSED_PORT_ID, LIMIT_SWITCH_CLOSED_PIN_ID) == LOGIC_LOW) ? TRUE : FALSE;
+	}
+	else
+	{
+		return (GPIO_readPinFast(LIMIT_SWITCH_OPEN_PORT_ID, LIMIT_SWITCH_OPEN_PIN_ID) == LOGIC_LOW) ? TRUE : FALSE;
+	}
+}
+
+/*
+ * Description :
+ * Save the address of the function called from the interrupt when a switch closes.
+ */
+void LIMIT_SWITCH_setCallBack(void(*a_ptr)(LimitSwitch_IdType id))
+{
+	g_limitSwitchCallBackPtr = a_ptr;
+}
+
+/*******************************************************************************
+ *                      Interrupt Service Routines                             *
+ *******************************************************************************/
+
+/*
+ * Only the first edge matters (the motor is stopped on it), so the contact
+ * bounce that follows is harmless and no debouncing is needed here.
+ */
+ISR(INT0_vect)
+{
+	if(g_limitSwitchCallBackPtr != NULL_PTR)
+	{
+		(*g_limitSwitchCallBackPtr)(LIMIT_SWITCH_DOOR_CLOSED);
+	}
+}
+
+ISR(INT1_vect)
+{
+	if(g_limitSwitchCallBackPtr != NULL_PTR)
+	{
+		(*g_limitSwitchCallBackPtr)(LIMIT_SWITCH_DOOR_OPEN);
+	}
+}
+
+#endif
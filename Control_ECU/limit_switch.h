@@ -0,0 +1,65 @@
+/******************************************************************************
+ *
+ * Module: Limit Switch
+ *
+ * File Name: limit_switch.h
+ *
+ * Description: Header file for the door limit switches driver (external interrupts)
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef LIMIT_SWITCH_H_
+#define LIMIT_SWITCH_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * The switches connect the pin to ground when the bolt reaches the end position
+ * (internal pull-up, active low). The door-closed switch is on INT0 (PD2) and the
+ * door-open switch is on INT1 (PD3), both interrupts are triggered on the falling edge.
+ * INT2 is left for the PIR sensor.
+ */
+#define LIMIT_SWITCH_CLOSED_PORT_ID     PORTD_ID
+#define LIMIT_SWITCH_CLOSED_PIN_ID      PIN2_ID
+
+#define LIMIT_SWITCH_OPEN_PORT_ID       PORTD_ID
+#define LIMIT_SWITCH_OPEN_PIN_ID        PIN3_ID
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef enum
+{
+	LIMIT_SWITCH_DOOR_OPEN,LIMIT_SWITCH_DOOR_CLOSED
+}LimitSwitch_IdType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Setup the switch pins as inputs with pull-ups and enable INT0/INT1 on the falling edge.
+ */
+void LIMIT_SWITCH_init(void);
+
+/*
+ * Description :
+ * Return TRUE if the required switch is closed (the bolt is at this end position).
+ */
+uint8 LIMIT_SWITCH_isClosed(LimitSwitch_IdType id);
+
+/*
+ * Description :
+ * Save the address of the function called from the interrupt when a switch closes.
+ */
+void LIMIT_SWITCH_setCallBack(void(*a_ptr)(LimitSwitch_IdType id));
+
+#endif /* LIMIT_SWITCH_H_ */
@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ * Module: Link
+ *
+ * File Name: link.h
+ *
+ * Description: Header file for the framed messages exchanged between the two ECUs over UART
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef LINK_H_
+#define LINK_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Frame format: START, type, length, payload[length], checksum
+ * The checksum is the XOR of type, length and the payload bytes.
+ * Any byte received outside a frame (the single byte commands and the '#'
+ * terminated passwords) is returned to the application as a plain byte, so
+ * START must not be used by the plain byte protocol.
+ */
+#define LINK_FRAME_START            0x21
+#define LINK_MAX_PAYLOAD            16
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef enum
+{
+	LINK_PLAIN_BYTE,   /* The byte is not part of a frame, the application handles it */
+	LINK_FRAME_BUSY,   /* The byte was taken by the frame being received */
+	LINK_FRAME_READY   /* A complete frame with a valid checksum is available */
+}LINK_ParseResultType;
+
+typedef struct
+{
+	uint8 type;
+	uint8 length;
+	uint8 payload[LINK_MAX_PAYLOAD];
+}LINK_FrameType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Send one frame through UART.
+ */
+void LINK_sendFrame(uint8 type, const uint8 *payload, uint8 length);
+
+/*
+ * Description :
+ * Feed one received byte to the frame parser. Frames with a wrong length or
+ * checksum, or received while the buffer pool is empty, are dropped silently.
+ */
+LINK_ParseResultType LINK_parseByte(uint8 data);
+
+/*
+ * Description :
+ * Take the last complete frame (NULL_PTR if none): the frame is not copied, the caller
+ * owns its pool block and gives it back with LINK_freeFrame.
+ */
+LINK_FrameType * LINK_getFrame(void);
+
+/*
+ * Description :
+ * Give the block of a frame taken with LINK_getFrame back to the pool.
+ */
+void LINK_freeFrame(LINK_FrameType * frame);
+
+#endif /* LINK_H_ */
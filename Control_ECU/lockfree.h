@@ -0,0 +1,193 @@
+/******************************************************************************
+ *
+ * Module: Lock-free Primitives
+ *
+ * File Name: lockfree.h
+ *
+ * Description: ISR-safe primitives to share data between the interrupts and the main loop
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef LOCKFREE_H_
+#define LOCKFREE_H_
+
+#include "std_types.h"
+#include <util/atomic.h>
+
+/*
+ * The AVR reads and writes one byte at a time: a single byte variable never tears,
+ * anything wider can be read half old / half new if an interrupt updates it in between.
+ * - LF_Ring      : single producer / single consumer byte queue with one byte indices,
+ *                  no interrupt masking at all (e.g. RX ISR -> main loop).
+ * - LF_readXX    : multi-byte read / write with the interrupts masked for a few cycles.
+ * - LF_Seqlock   : snapshot of a whole structure written by an ISR, the reader retries
+ *                  instead of masking the interrupts during the copy.
+ */
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Keep the compiler from moving memory accesses across this point (no code generated) */
+#define LF_BARRIER()                  __asm__ __volatile__("" ::: "memory")
+
+/*
+ * Define a ring with its buffer, size is a power of 2 up to 256 (one slot stays empty,
+ * so the ring holds size - 1 bytes).
+ */
+#define LF_RING_DEFINE(name, size) \
+	static uint8 name##_buffer[(size)]; \
+	static LF_RingType name = {0, 0, (uint8)((size) - 1), name##_buffer}
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef struct
+{
+	volatile uint8 head; /* Written by the producer only */
+	volatile uint8 tail; /* Written by the consumer only */
+	uint8 mask;
+	uint8 *buffer;
+}LF_RingType;
+
+/* Even = stable, odd = write in progress */
+typedef volatile uint8 LF_SeqlockType;
+
+/*******************************************************************************
+ *                      Inline Functions Definitions                           *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Producer side: store a byte, return FALSE if the ring is full (the byte is dropped).
+ */
+static inline uint8 LF_ringPut(LF_RingType * ring_Ptr, uint8 data)
+{
+	uint8 head = ring_Ptr->head;
+	uint8 next = (head + 1) & ring_Ptr->mask;
+
+	if(next == ring_Ptr->tail)
+	{
+		return FALSE;
+	}
+	ring_Ptr->buffer[head] = data;
+	/* The byte must be in the buffer before the consumer can see the new head */
+	LF_BARRIER();
+	ring_Ptr->head = next;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Consumer side: take a byte, return FALSE if the ring is empty.
+ */
+static inline uint8 LF_ringGet(LF_RingType * ring_Ptr, uint8 * data_Ptr)
+{
+	uint8 tail = ring_Ptr->tail;
+
+	if(tail == ring_Ptr->head)
+	{
+		return FALSE;
+	}
+	*data_Ptr = ring_Ptr->buffer[tail];
+	/* The byte must be read before the producer can reuse the slot */
+	LF_BARRIER();
+	ring_Ptr->tail = (tail + 1) & ring_Ptr->mask;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Number of bytes in the ring, exact from the consumer side, a lower bound elsewhere.
+ */
+static inline uint8 LF_ringCount(const LF_RingType * ring_Ptr)
+{
+	return (ring_Ptr->head - ring_Ptr->tail) & ring_Ptr->mask;
+}
+
+/*
+ * Description :
+ * Multi-byte read and write of a variable shared with an ISR (interrupts masked for 2 / 4 loads).
+ */
+static inline uint16 LF_read16(const volatile uint16 * var_Ptr)
+{
+	uint16 value;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = *var_Ptr;
+	}
+	return value;
+}
+
+static inline void LF_write16(volatile uint16 * var_Ptr, uint16 value)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*var_Ptr = value;
+	}
+}
+
+static inline uint32 LF_read32(const volatile uint32 * var_Ptr)
+{
+	uint32 value;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = *var_Ptr;
+	}
+	return value;
+}
+
+static inline void LF_write32(volatile uint32 * var_Ptr, uint32 value)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*var_Ptr = value;
+	}
+}
+
+/*
+ * Description :
+ * Writer side of a sequence lock, the data is written between begin and end.
+ * The writer must not be interrupted by a reader: write from an ISR (or with the
+ * interrupts disabled) and read from the main loop.
+ */
+static inline void LF_seqlockWriteBegin(LF_SeqlockType * lock_Ptr)
+{
+	(*lock_Ptr)++;
+	LF_BARRIER();
+}
+
+static inline void LF_seqlockWriteEnd(LF_SeqlockType * lock_Ptr)
+{
+	LF_BARRIER();
+	(*lock_Ptr)++;
+}
+
+/*
+ * Description :
+ * Reader side of a sequence lock: copy size bytes from the shared data, retried until
+ * no write happened during the copy. The interrupts stay enabled.
+ */
+static inline void LF_seqlockRead(const LF_SeqlockType * lock_Ptr, void * dest_Ptr, const volatile void * src_Ptr, uint8 size)
+{
+	uint8 sequence;
+	uint8 i;
+
+	do
+	{
+		sequence = *lock_Ptr;
+		LF_BARRIER();
+		for(i = 0; i < size; i++)
+		{
+			((uint8 *)dest_Ptr)[i] = ((const volatile uint8 *)src_Ptr)[i];
+		}
+		LF_BARRIER();
+	}while((sequence & 1) || (sequence != *lock_Ptr));
+}
+
+#endif /* LOCKFREE_H_ */
@@ -0,0 +1,85 @@
+/******************************************************************************
+ *
+ * Module: Performance Counters
+ *
+ * File Name: perf.c
+ *
+ * Description: Source file for the runtime performance counters
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "perf.h"
+#include "link.h"
+#include <util/atomic.h> /* Counters are updated from the ISRs too */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static uint32 g_counters[PERF_COUNTER_COUNT];
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add value to a counter, safe from the main loop and the ISRs.
+ */
+void PERF_add(uint8 id, uint32 value)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_counters[id] += value;
+	}
+}
+
+/*
+ * Description :
+ * Copy all the counters at the same instant into counters (PERF_COUNTER_COUNT entries).
+ */
+void PERF_snapshot(uint32 * counters)
+{
+	uint8 i;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for(i = 0; i < PERF_COUNTER_COUNT; i++)
+		{
+			counters[i] = g_counters[i];
+		}
+	}
+}
+
+/*
+ * Description :
+ * Take a snapshot and send it over UART as PERF_COUNTERS_FRAME frames.
+ */
+void PERF_send(void)
+{
+	uint32 counters[PERF_COUNTER_COUNT];
+	uint8 payload[2 + (4 * PERF_COUNTERS_PER_FRAME)];
+	uint8 id = 0;
+	uint8 length;
+
+	/* The bytes sent below are counted after the snapshot, not in it */
+	PERF_snapshot(counters);
+
+	while(id < PERF_COUNTER_COUNT)
+	{
+		payload[0] = PERF_ECU_ID;
+		payload[1] = id;
+		length = 2;
+		while((id < PERF_COUNTER_COUNT) && (length < sizeof(payload)))
+		{
+			payload[length++] = (uint8)counters[id];
+			payload[length++] = (uint8)(counters[id] >> 8);
+			payload[length++] = (uint8)(counters[id] >> 16);
+			payload[length++] = (uint8)(counters[id] >> 24);
+			id++;
+		}
+		LINK_sendFrame(PERF_COUNTERS_FRAME, payload, length);
+	}
+}
@@ -12,21 +12,118 @@
 
 #include "pir.h"
 #include "avr/io.h"
-#include "common_macros.h" // For BIT_IS_CLEAR and BIT_IS_SET macros
+#include "avr/interrupt.h"
+#include "util/atomic.h" // To read and update the 16-bit counters without tearing
+#include "common_macros.h" // For SET_BIT and CLEAR_BIT macros
 #include "gpio.h"
+#include "perf.h" // The motion events are reported with the performance counters
+
+/* Occupancy state, updated by the INT2 interrupt (motion edges) and PIR_tick (hold time) */
+static volatile uint8 g_motionActive = FALSE;
+static volatile uint8 g_occupied = FALSE;
+static volatile uint16 g_holdTime = 0;
+static void (*volatile g_PIR_CallBackPtr)(void) = NULL_PTR;
+
+/* Follow the sensor output level and arm INT2 for the opposite edge (INT2 has one edge only) */
+static void PIR_updateMotion(void)
+{
+	uint8 level;
+
+	do
+	{
+		level = GPIO_readPinFast(PIR_SENSOR_PORT, PIR_SENSOR_PIN);
+		if(level == LOGIC_HIGH)
+		{
+			if(g_motionActive == FALSE)
+			{
+				PERF_COUNT(PERF_PIR_MOTIONS);
+			}
+			g_motionActive = TRUE;
+			g_occupied = TRUE;
+			CLEAR_BIT(MCUCSR,ISC2); // Wait for the falling edge (end of motion)
+		}
+		else
+		{
+			g_motionActive = FALSE;
+			g_holdTime = 0; // The hold time starts at the end of the last motion
+			SET_BIT(MCUCSR,ISC2); // Wait for the rising edge (motion)
+		}
+		GIFR = (1 << INTF2); // Changing ISC2 can set the flag, clear it
+	}
+	while(GPIO_readPinFast(PIR_SENSOR_PORT, PIR_SENSOR_PIN) != level); // The level changed while re-arming
+}
+
 void PIR_init(void)
 {
-	GPIO_setupPinDirection(PIR_SENSOR_PORT,PIR_SENSOR_PIN ,PIN_OUTPUT);// Set the PIR sensor pin as an input
-	GPIO_writePin(PIR_SENSOR_PORT, PIR_SENSOR_PIN, LOGIC_LOW); // Clear the bit to set as input
+	GPIO_setupPinDirectionFast(PIR_SENSOR_PORT,PIR_SENSOR_PIN ,PIN_INPUT);// Set the PIR sensor pin as an input
+	GPIO_writePinFast(PIR_SENSOR_PORT, PIR_SENSOR_PIN, LOGIC_LOW); // No pull-up, the sensor drives the pin
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_occupied = FALSE;
+		// A sensor already high at power up is not a new event
+		g_motionActive = (GPIO_readPinFast(PIR_SENSOR_PORT, PIR_SENSOR_PIN) == LOGIC_HIGH) ? TRUE : FALSE;
+		PIR_updateMotion(); // Start from the current level
+		SET_BIT(GICR,INT2); // Enable INT2
+	}
+}
+
+uint8 PIR_isOccupied(void)
+{
+	return g_occupied;
+}
+
+void PIR_restartHoldTime(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_holdTime = 0;
+		g_occupied = TRUE;
+	}
+}
+
+uint16 PIR_getHoldTimeRemaining(void)
+{
+	uint16 remaining = 0;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(g_motionActive == TRUE)
+		{
+			remaining = PIR_HOLD_TIME_MS;
+		}
+		else if(g_occupied == TRUE)
+		{
+			remaining = PIR_HOLD_TIME_MS - g_holdTime;
+		}
+	}
+
+	return remaining;
+}
+
+void PIR_setCallBack(void(*a_ptr)(void))
+{
+	g_PIR_CallBackPtr = a_ptr;
+}
+
+void PIR_tick(void)
+{
+	// Count the time since the last motion ended, the area is vacant after PIR_HOLD_TIME_MS
+	if((g_occupied == TRUE) && (g_motionActive == FALSE))
+	{
+		if(++g_holdTime >= PIR_HOLD_TIME_MS)
+		{
+			g_occupied = FALSE;
+			if(g_PIR_CallBackPtr != NULL_PTR)
+			{
+				(*g_PIR_CallBackPtr)();
+			}
+		}
+	}
 }
 
-uint8 PIR_getState(void)
+ISR(INT2_vect)
 {
-    // Read the state of the PIR sensor
-    // Return 1 if motion is detected, otherwise return 0
-    if (GPIO_readPin(PIR_SENSOR_PORT,PIR_SENSOR_PIN)) // Check if the PIR pin is high
-    {
-        return 1; // Motion detected
-    }
-    return 0; // No motion detected
+	// Motion started or ended
+	PIR_updateMotion();
 }
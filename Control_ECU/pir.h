@@ -14,12 +14,50 @@
 #define PIR_H_
 
 #include "std_types.h"
-#define PIR_SENSOR_PORT PORTC_ID // Define the port connected to the PIR sensor
-#define PIR_SENSOR_PIN PIN2_ID  // Define the pin connected to the PIR sensor
+/*
+ * Hardware change: the PIR output moved from PC2 to PB2 (INT2) so motion can raise an interrupt.
+ * The board and "Final Project.pdsprj" still wire it to PC2, rewire the sensor output to PB2.
+ */
+#define PIR_SENSOR_PORT PORTB_ID // Define the port connected to the PIR sensor (INT2)
+#define PIR_SENSOR_PIN PIN2_ID  // Define the pin connected to the PIR sensor (INT2)
+#define PIR_HOLD_TIME_MS 5000 // The area is vacant when no motion is seen for this time
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 void PIR_init(void);
-uint8 PIR_getState(void);
+
+/*
+ * Description :
+ * Return TRUE while the area is occupied: motion is detected, or the last motion
+ * ended less than PIR_HOLD_TIME_MS ago.
+ */
+uint8 PIR_isOccupied(void);
+
+/*
+ * Description :
+ * Mark the area as occupied and restart the hold time, e.g. when the door is
+ * unlocked so it re-locks PIR_HOLD_TIME_MS later even if nobody passes.
+ */
+void PIR_restartHoldTime(void);
+
+/*
+ * Description :
+ * Return the time in ms until the area becomes vacant if no new motion is seen
+ * (PIR_HOLD_TIME_MS while motion is detected, 0 when vacant).
+ */
+uint16 PIR_getHoldTimeRemaining(void);
+
+/*
+ * Description :
+ * Save the address of the function called from the tick interrupt when the
+ * area becomes vacant.
+ */
+void PIR_setCallBack(void(*a_ptr)(void));
+
+/*
+ * Description :
+ * Count the hold time, should be called from the 1 kHz system tick.
+ */
+void PIR_tick(void);
 
 #endif /* PIR_H_ */
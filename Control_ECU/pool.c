@@ -0,0 +1,127 @@
+/******************************************************************************
+ *
+ * Module: Buffer Pool
+ *
+ * File Name: pool.c
+ *
+ * Description: Source file for the fixed-block message buffer pool
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "pool.h"
+#include "link.h"
+#include <util/atomic.h> /* Blocks are taken and given back from the ISRs too */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static uint8 g_blocks[POOL_BLOCK_COUNT][POOL_BLOCK_SIZE];
+
+/* Stack of the free block indices, g_freeList[0..g_freeCount-1] are free */
+static uint8 g_freeList[POOL_BLOCK_COUNT];
+static uint8 g_freeCount = 0;
+static uint8 g_minFreeCount = POOL_BLOCK_COUNT;
+static uint16 g_failures = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Put all the blocks in the free list, call it before the other modules use the pool.
+ */
+void POOL_init(void)
+{
+	uint8 i;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for(i = 0; i < POOL_BLOCK_COUNT; i++)
+		{
+			g_freeList[i] = i;
+		}
+		g_freeCount = POOL_BLOCK_COUNT;
+		g_minFreeCount = POOL_BLOCK_COUNT;
+	}
+}
+
+/*
+ * Description :
+ * Take a block from the pool, return NULL_PTR if all blocks are in use.
+ * O(1), safe from the main loop and the ISRs.
+ */
+void * POOL_alloc(void)
+{
+	void *block = NULL_PTR;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(g_freeCount != 0)
+		{
+			block = g_blocks[g_freeList[--g_freeCount]];
+			if(g_freeCount < g_minFreeCount)
+			{
+				g_minFreeCount = g_freeCount;
+			}
+		}
+		else if(g_failures != 0xFFFF)
+		{
+			g_failures++;
+		}
+	}
+	return block;
+}
+
+/*
+ * Description :
+ * Give a block back to the pool, NULL_PTR is ignored. O(1), safe from the main loop and the ISRs.
+ */
+void POOL_free(void * block)
+{
+	if(block == NULL_PTR)
+	{
+		return;
+	}
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		/* Index from the address, the blocks are contiguous */
+		g_freeList[g_freeCount++] = (uint8)(((uint8 *)block - g_blocks[0]) / POOL_BLOCK_SIZE);
+	}
+}
+
+/*
+ * Description :
+ * Copy the occupancy statistics into the given structure.
+ */
+void POOL_getStats(POOL_StatsType * stats_Ptr)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		stats_Ptr->free_blocks = g_freeCount;
+		stats_Ptr->min_free_blocks = g_minFreeCount;
+		stats_Ptr->failures = g_failures;
+	}
+}
+
+/*
+ * Description :
+ * Send the occupancy statistics over UART as a POOL_REPORT_FRAME.
+ */
+void POOL_send(void)
+{
+	POOL_StatsType stats;
+	uint8 payload[5];
+
+	POOL_getStats(&stats);
+	payload[0] = POOL_BLOCK_COUNT;
+	payload[1] = stats.free_blocks;
+	payload[2] = stats.min_free_blocks;
+	payload[3] = (uint8)stats.failures;
+	payload[4] = (uint8)(stats.failures >> 8);
+	LINK_sendFrame(POOL_REPORT_FRAME, payload, sizeof(payload));
+}
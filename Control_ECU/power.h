@@ -0,0 +1,86 @@
+/******************************************************************************
+ *
+ * Module: Power
+ *
+ * File Name: power.h
+ *
+ * Description: Header file for the idle sleep of the wait loops
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include "std_types.h"
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * The wait loops sleep in idle mode: the CPU stops, the timers, the UART and the ADC
+ * keep running and any interrupt wakes it up within 6 cycles. Power-down would stop the
+ * 1 kHz system tick (and the keypad scan with it) and the UART receiver, only INT0..2,
+ * the TWI address match and the watchdog can wake the ATmega32 from it.
+ */
+
+/* Link frames of the power report */
+#define POWER_QUERY_FRAME             0x1E /* Request, no payload */
+#define POWER_REPORT_FRAME            0x1F /* Wake-ups (4 bytes), ms asleep (4 bytes), ms since boot (4 bytes), last and max wake to handle time in us (2 + 2 bytes) */
+
+/*
+ * Sleep until the next interrupt unless the condition is TRUE. The condition is evaluated
+ * with the interrupts disabled, so an interrupt making it TRUE cannot be missed.
+ */
+#define POWER_SLEEP_UNLESS(condition) \
+	do \
+	{ \
+		cli(); \
+		if(condition) \
+		{ \
+			sei(); \
+		} \
+		else \
+		{ \
+			POWER_idle(); \
+		} \
+	}while(0)
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Select the idle sleep mode.
+ */
+void POWER_init(void);
+
+/*
+ * Description :
+ * Sleep in idle mode until the next interrupt. Call it with the interrupts disabled after
+ * checking that there is nothing to do (see POWER_SLEEP_UNLESS): they are enabled together
+ * with the sleep, so the interrupt cannot run between the check and the sleep.
+ * Returns with the interrupts enabled, after the wake-up interrupt ran.
+ */
+void POWER_idle(void);
+
+/*
+ * Description :
+ * Record the time from the last wake-up to the handling of the event that caused it,
+ * called by the application when it starts handling an event. Only the first call after
+ * a wake-up is recorded.
+ */
+void POWER_eventHandled(void);
+
+/*
+ * Description :
+ * Send the wake-ups, the time asleep and the wake to handle times over UART
+ * as a POWER_REPORT_FRAME.
+ */
+void POWER_send(void);
+
+#endif /* POWER_H_ */
@@ -4,7 +4,7 @@
  *
  * File Name: pwm.c
  *
- * Description: Source file for the ATmega32 PWM driver using Timer0
+ * Description: Source file for the ATmega32 PWM driver (Timer0 or Timer1)
  *
  * Author: Omar Sherif
  *
@@ -14,12 +14,54 @@
 #include "common_macros.h" /* To use macros like SET_BIT */
 #include "pwm.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if (PWM_BACKEND == PWM_BACKEND_TIMER0)
+
+/* Timer0 clock select bits for the selected prescaler */
+#if (PWM_TIMER0_PRESCALER == 1)
+#define PWM_TIMER0_CLOCK_BITS       (1 << CS00)
+#elif (PWM_TIMER0_PRESCALER == 8)
+#define PWM_TIMER0_CLOCK_BITS       (1 << CS01)
+#elif (PWM_TIMER0_PRESCALER == 64)
+#define PWM_TIMER0_CLOCK_BITS       ((1 << CS01) | (1 << CS00))
+#elif (PWM_TIMER0_PRESCALER == 256)
+#define PWM_TIMER0_CLOCK_BITS       (1 << CS02)
+#else
+#define PWM_TIMER0_CLOCK_BITS       ((1 << CS02) | (1 << CS00))
+#endif
+
+#elif (PWM_BACKEND == PWM_BACKEND_TIMER1)
+
+/* Timer1 clock select bits for the selected prescaler */
+#if (PWM_TIMER1_PRESCALER == 1)
+#define PWM_TIMER1_CLOCK_BITS       (1 << CS10)
+#elif (PWM_TIMER1_PRESCALER == 8)
+#define PWM_TIMER1_CLOCK_BITS       (1 << CS11)
+#elif (PWM_TIMER1_PRESCALER == 64)
+#define PWM_TIMER1_CLOCK_BITS       ((1 << CS11) | (1 << CS10))
+#elif (PWM_TIMER1_PRESCALER == 256)
+#define PWM_TIMER1_CLOCK_BITS       (1 << CS12)
+#elif (PWM_TIMER1_PRESCALER == 1024)
+#define PWM_TIMER1_CLOCK_BITS       ((1 << CS12) | (1 << CS10))
+#else
+#error "PWM_TIMER1_PRESCALER should be 1, 8, 64, 256 or 1024"
+#endif
+
+#endif
+
 /******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
 
-void PWM_Timer0_Start(uint8 duty_cycle)
+void PWM_init(void)
 {
+#if (PWM_BACKEND == PWM_BACKEND_TIMER0)
+    /* Start with 0% duty cycle */
+    OCR0 = 0;
+
     /* Set OC0 pin (PB3) as output pin */
     SET_BIT(DDRB, PB3);  // OC0 pin is PB3 on ATmega32
 
@@ -29,11 +71,53 @@ void PWM_Timer0_Start(uint8 duty_cycle)
      * COM01 = 1 for Non-inverting mode (output on OC0)
      * COM00 = 0 (no toggle on compare match)
      *
-     * Set prescaler to F_CPU/64
-     * CS02 = 0, CS01 = 1, CS00 = 1
+     * CS02:0 = PWM_TIMER0_PRESCALER (F_CPU/64 @ 8MHz)
      */
-    TCCR0 = (1 << WGM00) | (1 << WGM01) | (1 << COM01) | (1 << CS01) | (1 << CS00);
+    TCCR0 = (1 << WGM00) | (1 << WGM01) | (1 << COM01) | PWM_TIMER0_CLOCK_BITS;
+
+#elif (PWM_BACKEND == PWM_BACKEND_TIMER1)
+    /* Start with 0% duty cycle, the counter TOP sets the PWM frequency */
+    TCNT1 = 0;
+    ICR1 = PWM_DUTY_MAX;
 
-    /* Set duty cycle based on the input percentage (0-100%) */
-    OCR0 = (duty_cycle * 255) / 100; // Convert percentage to 8-bit value (0-255)
+#if (PWM_TIMER1_CHANNEL == PWM_TIMER1_OC1A)
+    OCR1A = 0;
+    /* Set OC1A pin (PD5) as output pin */
+    SET_BIT(DDRD, PD5);
+    /* COM1A1 = 1 for Non-inverting mode on OC1A, WGM11 = 1 (Fast PWM, TOP = ICR1) */
+    TCCR1A = (1 << COM1A1) | (1 << WGM11);
+#else
+    OCR1B = 0;
+    /* Set OC1B pin (PD4) as output pin */
+    SET_BIT(DDRD, PD4);
+    /* COM1B1 = 1 for Non-inverting mode on OC1B, WGM11 = 1 (Fast PWM, TOP = ICR1) */
+    TCCR1A = (1 << COM1B1) | (1 << WGM11);
+#endif
+
+    /* WGM13 = 1, WGM12 = 1 to complete mode 14 (Fast PWM, TOP = ICR1) and start the clock */
+    TCCR1B = (1 << WGM13) | (1 << WGM12) | PWM_TIMER1_CLOCK_BITS;
+#endif
+}
+
+void PWM_setDuty(uint16 duty)
+{
+    if(duty > PWM_DUTY_MAX)
+    {
+        duty = PWM_DUTY_MAX;
+    }
+
+    /* The compare register is double buffered in Fast PWM mode, the new value is used from the next period */
+#if (PWM_BACKEND == PWM_BACKEND_TIMER0)
+    OCR0 = (uint8)duty;
+#elif (PWM_TIMER1_CHANNEL == PWM_TIMER1_OC1A)
+    OCR1A = duty;
+#else
+    OCR1B = duty;
+#endif
+}
+
+void PWM_setDutyPercent(uint8 duty_cycle)
+{
+    /* Convert percentage to the compare value range (0 - PWM_DUTY_MAX) */
+    PWM_setDuty((uint16)(((uint32)duty_cycle * PWM_DUTY_MAX) / 100));
 }
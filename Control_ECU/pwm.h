@@ -4,7 +4,7 @@
  *
  * File Name: pwm.h
  *
- * Description: Header file for the ATmega32 PWM driver using Timer0
+ * Description: Header file for the ATmega32 PWM driver (Timer0 or Timer1)
  *
  * Author: Omar Sherif
  *
@@ -15,17 +15,108 @@
 
 #include "std_types.h" /* For standard types like uint8 */
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Available PWM backends */
+#define PWM_BACKEND_TIMER0          0 /* 8-bit Fast PWM on OC0 (PB3) */
+#define PWM_BACKEND_TIMER1          1 /* 16-bit Fast PWM (TOP = ICR1) on OC1A (PD5) or OC1B (PD4) */
+
+/* Selected PWM backend, Timer1 gives a finer duty cycle and frees Timer0 */
+#define PWM_BACKEND                 PWM_BACKEND_TIMER0
+
+#if (PWM_BACKEND == PWM_BACKEND_TIMER0)
+
+/*
+ * PWM frequency = F_CPU/(prescaler*256), the prescaler is the largest one keeping the
+ * frequency at or above PWM_TIMER0_MIN_FREQUENCY: F_CPU/64 = 488Hz @ 8MHz, 976Hz @ 16MHz.
+ */
+#define PWM_TIMER0_MIN_FREQUENCY    400
+#define PWM_TIMER0_FREQUENCY(prescaler) (F_CPU / ((prescaler) * 256UL))
+
+#if (PWM_TIMER0_FREQUENCY(1024) >= PWM_TIMER0_MIN_FREQUENCY)
+#define PWM_TIMER0_PRESCALER        1024
+#elif (PWM_TIMER0_FREQUENCY(256) >= PWM_TIMER0_MIN_FREQUENCY)
+#define PWM_TIMER0_PRESCALER        256
+#elif (PWM_TIMER0_FREQUENCY(64) >= PWM_TIMER0_MIN_FREQUENCY)
+#define PWM_TIMER0_PRESCALER        64
+#elif (PWM_TIMER0_FREQUENCY(8) >= PWM_TIMER0_MIN_FREQUENCY)
+#define PWM_TIMER0_PRESCALER        8
+#elif (PWM_TIMER0_FREQUENCY(1) >= PWM_TIMER0_MIN_FREQUENCY)
+#define PWM_TIMER0_PRESCALER        1
+#else
+#error "PWM_TIMER0_MIN_FREQUENCY is too high for this F_CPU"
+#endif
+
+#define PWM_DUTY_MAX                255
+
+#elif (PWM_BACKEND == PWM_BACKEND_TIMER1)
+
+/* Timer1 output compare channel used for the PWM signal */
+#define PWM_TIMER1_OC1A             0
+#define PWM_TIMER1_OC1B             1
+#define PWM_TIMER1_CHANNEL          PWM_TIMER1_OC1A
+
+/* Required PWM frequency in Hz */
+#define PWM_TIMER1_FREQUENCY        1000
+
+/* Counter TOP for a prescaler, the prescaler is the smallest one (finest duty cycle) whose TOP fits 16 bits */
+#define PWM_TIMER1_TOP(prescaler)   ((F_CPU / ((prescaler) * PWM_TIMER1_FREQUENCY)) - 1)
+
+#if (PWM_TIMER1_TOP(1) <= 65535)
+#define PWM_TIMER1_PRESCALER        1
+#elif (PWM_TIMER1_TOP(8) <= 65535)
+#define PWM_TIMER1_PRESCALER        8
+#elif (PWM_TIMER1_TOP(64) <= 65535)
+#define PWM_TIMER1_PRESCALER        64
+#elif (PWM_TIMER1_TOP(256) <= 65535)
+#define PWM_TIMER1_PRESCALER        256
+#elif (PWM_TIMER1_TOP(1024) <= 65535)
+#define PWM_TIMER1_PRESCALER        1024
+#else
+#error "PWM_TIMER1_FREQUENCY is too low for this F_CPU, the counter TOP exceeds 16 bits"
+#endif
+
+/* TOP value of the counter, it is also the duty cycle resolution (8000 steps = ~13 bits @ 8MHz, 1kHz) */
+#define PWM_DUTY_MAX                PWM_TIMER1_TOP(PWM_TIMER1_PRESCALER)
+
+#if (PWM_DUTY_MAX < 1023)
+#error "PWM_TIMER1_FREQUENCY is too high for this F_CPU, the duty cycle resolution is less than 10 bits"
+#endif
+
+#else
+#error "PWM_BACKEND should be PWM_BACKEND_TIMER0 or PWM_BACKEND_TIMER1"
+#endif
+
 /*******************************************************************************
  *                      Function Prototypes                                    *
  *******************************************************************************/
 
 /*
  * Description:
- * Function to initialize Timer0 in Fast PWM mode and start PWM signal generation.
- * The function sets the required duty cycle.
+ * Function to configure the selected timer in Fast PWM mode once and start
+ * the PWM signal with 0% duty cycle.
+ */
+void PWM_init(void);
+
+/*
+ * Description:
+ * Function to set the duty cycle, it only writes the (double buffered) compare
+ * register so it is cheap enough to be called from an ISR.
+ *
+ * Parameters:
+ * - duty: A value from 0 to PWM_DUTY_MAX.
+ */
+void PWM_setDuty(uint16 duty);
+
+/*
+ * Description:
+ * Function to set the duty cycle as a percentage.
  *
  * Parameters:
  * - duty_cycle: A value from 0 to 100 representing the percentage of the duty cycle.
  */
-void PWM_Timer0_Start(uint8 duty_cycle);
+void PWM_setDutyPercent(uint8 duty_cycle);
+
 #endif /* PWM_H_ */
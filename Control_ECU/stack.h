@@ -0,0 +1,63 @@
+/******************************************************************************
+ *
+ * Module: Stack Monitor
+ *
+ * File Name: stack.h
+ *
+ * Description: Header file for the stack painting and SRAM high-water mark
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef STACK_H_
+#define STACK_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Before main, the free SRAM between the static variables (_end) and the top of the
+ * stack is filled with STACK_CANARY. The stack grows down from RAMEND, the lowest
+ * address where the pattern was overwritten is the deepest the stack ever went.
+ * No heap is used (no malloc), so nothing else writes this area.
+ */
+#define STACK_CANARY                  0xC5
+
+/* Link frames of the SRAM usage query */
+#define STACK_QUERY_FRAME             0x18 /* Request, no payload */
+#define STACK_REPORT_FRAME            0x19 /* Static, max stack, never used, total SRAM: 2 bytes each, little endian */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef struct
+{
+	uint16 static_bytes;    /* .data + .bss, fixed at link time */
+	uint16 max_stack_bytes; /* Deepest stack use since reset (high-water mark) */
+	uint16 free_bytes;      /* Never used by the stack, the margin left */
+	uint16 total_bytes;     /* Whole SRAM of the part */
+}STACK_UsageType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Measure the SRAM usage: scans the painted area up to the first overwritten byte,
+ * call it from the main loop only (up to ~2 KB read).
+ */
+void STACK_getUsage(STACK_UsageType * usage_Ptr);
+
+/*
+ * Description :
+ * Measure the SRAM usage and send it over UART as a STACK_REPORT_FRAME.
+ */
+void STACK_send(void);
+
+#endif /* STACK_H_ */
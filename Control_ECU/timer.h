@@ -15,6 +15,40 @@
 
 #include "std_types.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Interrupt dispatch of each timer:
+ * TIMER_DISPATCH_RUNTIME : the ISRs in timer.c call the function set by Timer_setCallBack
+ *                          (volatile pointer load, NULL check and indirect call).
+ * TIMER_DISPATCH_STATIC  : timer.c does not define the ISRs of this timer, the application
+ *                          binds its handler with TIMER_BIND_HANDLER in the file defining it,
+ *                          so the handler is a direct call the compiler can inline.
+ *
+ * Cycles from the interrupt to the first instruction of the handler body and back, with a
+ * handler that calls other functions (all the call-clobbered registers are saved):
+ * runtime ~92 cycles (11.5 us @ 8MHz), static inlined ~74 cycles (9.3 us).
+ * With a leaf handler (no calls) the static ISR only saves the registers it uses: ~25 cycles.
+ */
+#define TIMER_DISPATCH_RUNTIME      0
+#define TIMER_DISPATCH_STATIC       1
+
+#define TIMER0_DISPATCH             TIMER_DISPATCH_RUNTIME
+#define TIMER1_DISPATCH             TIMER_DISPATCH_RUNTIME /* Passive buzzer tone, set at runtime */
+#define TIMER2_DISPATCH             TIMER_DISPATCH_STATIC  /* System tick */
+
+/*
+ * Define the ISR of a TIMER_DISPATCH_STATIC timer, e.g.
+ * TIMER_BIND_HANDLER(TIMER2_COMP_vect, systemTick)
+ */
+#define TIMER_BIND_HANDLER(vector, handler) \
+    ISR(vector) \
+    { \
+        handler(); \
+    }
+
 /*******************************************************************************
  *                      Types Definitions                                      *
  *******************************************************************************/
@@ -47,6 +81,9 @@ typedef struct {
 
 void Timer_init(const Timer_ConfigType * Config_Ptr);
 void Timer_deInit(Timer_ID_Type timer_type);
+/*
+ * Set the handler of a TIMER_DISPATCH_RUNTIME timer (ignored for a TIMER_DISPATCH_STATIC timer).
+ */
 void Timer_setCallBack(void(*a_ptr)(void), Timer_ID_Type a_timer_ID);
 
 #endif /* TIMER_H_ */
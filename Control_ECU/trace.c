@@ -0,0 +1,120 @@
+/******************************************************************************
+ *
+ * Module: Trace
+ *
+ * File Name: trace.c
+ *
+ * Description: Source file for the latency trace ring buffer
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "trace.h"
+#include "link.h"
+#include "clock.h" /* Time base of the entries */
+#include <util/atomic.h> /* Entries are written from the ISRs too */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef struct
+{
+	uint32 time_us;
+	uint8 id;
+	uint8 data;
+}TRACE_EntryType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static TRACE_EntryType g_entries[TRACE_BUFFER_SIZE];
+static uint8 g_head = 0;    /* Next entry to write */
+static uint8 g_count = 0;   /* Entries in the buffer */
+static uint16 g_dropped = 0; /* Entries overwritten since the last dump */
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Store an entry (time, id, data) in the ring buffer, safe from the main loop and the ISRs.
+ * Use TRACE_POINT so the trace points can be compiled out.
+ */
+void TRACE_record(uint8 id, uint8 data)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		TRACE_EntryType *entry_Ptr = &g_entries[g_head];
+
+		entry_Ptr->time_us = Clock_micros();
+		entry_Ptr->id = id;
+		entry_Ptr->data = data;
+		g_head = (g_head + 1) & (TRACE_BUFFER_SIZE - 1);
+		if(g_count < TRACE_BUFFER_SIZE)
+		{
+			g_count++;
+		}
+		else
+		{
+			g_dropped++;
+		}
+	}
+}
+
+/*
+ * Description :
+ * Send the whole ring buffer over UART as TRACE_ENTRIES_FRAME frames followed by a
+ * TRACE_END_FRAME, then empty it. Blocks for the transmission (~300 ms @ 9600 baud).
+ */
+void TRACE_dump(void)
+{
+	uint8 payload[TRACE_ENTRY_SIZE * TRACE_ENTRIES_PER_FRAME];
+	uint8 index;
+	uint8 count;
+	uint8 sent = 0;
+	uint8 length = 0;
+	uint16 dropped;
+
+	/* Take the current content, entries recorded during the dump are kept for the next one */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		count = g_count;
+		index = (g_head - count) & (TRACE_BUFFER_SIZE - 1);
+		dropped = g_dropped;
+		g_count = 0;
+		g_dropped = 0;
+	}
+
+	while(sent < count)
+	{
+		TRACE_EntryType entry;
+
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			entry = g_entries[index];
+		}
+		payload[length++] = (uint8)entry.time_us;
+		payload[length++] = (uint8)(entry.time_us >> 8);
+		payload[length++] = (uint8)(entry.time_us >> 16);
+		payload[length++] = (uint8)(entry.time_us >> 24);
+		payload[length++] = entry.id;
+		payload[length++] = entry.data;
+		index = (index + 1) & (TRACE_BUFFER_SIZE - 1);
+		sent++;
+
+		if((length == sizeof(payload)) || (sent == count))
+		{
+			LINK_sendFrame(TRACE_ENTRIES_FRAME, payload, length);
+			length = 0;
+		}
+	}
+
+	payload[0] = sent;
+	payload[1] = (uint8)dropped;
+	payload[2] = (uint8)(dropped >> 8);
+	LINK_sendFrame(TRACE_END_FRAME, payload, 3);
+}
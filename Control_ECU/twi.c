@@ -13,11 +13,12 @@
 #include "twi.h"
 #include "common_macros.h"
 #include <avr/io.h>
+#include "perf.h" /* To count the NACKs */
 
 void TWI_init(const TWI_ConfigType *Config_Ptr)
 {
     /* Set the bit rate based on the provided configuration */
-    TWBR = (F_CPU / (2 * Config_Ptr->bit_rate)) - 8; // Calculate TWBR for desired baud rate
+    TWBR = (uint8)TWI_TWBR_VALUE(Config_Ptr->bit_rate); // Calculate TWBR for the SCL frequency
     TWSR = 0x00; // Prescaler = 1
 
     /* Set the TWI address for the device */
@@ -102,5 +103,11 @@ uint8 TWI_getStatus(void)
     /* Masking to eliminate first 3 bits and get the last 5 bits (status bits) */
     status = TWSR & 0xF8;
 
+    /* Slave not responding or rejecting the data */
+    if ((status == TWI_MT_SLA_W_NACK) || (status == TWI_MT_DATA_NACK) || (status == TWI_MT_SLA_R_NACK))
+    {
+        PERF_COUNT(PERF_TWI_NACKS);
+    }
+
     return status;
 }
@@ -27,6 +27,23 @@
 #define TWI_MT_DATA_ACK   0x28 /* Master transmit data and ACK has been received from Slave. */
 #define TWI_MR_DATA_ACK   0x50 /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_NACK  0x58 /* Master received data but doesn't send ACK to slave. */
+#define TWI_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
+#define TWI_MT_DATA_NACK  0x30 /* Master transmit data and NACK has been received from Slave. */
+#define TWI_MT_SLA_R_NACK 0x48 /* Master transmit ( slave address + Read request ) to slave + NACK received from slave. */
+
+/*
+ * SCL frequency of the bus, SCL = F_CPU / (16 + 2 * TWBR) with the TWI prescaler at 1.
+ * TWBR should be 10 or more in master mode, which limits SCL to F_CPU/36 (222 kHz @ 8MHz).
+ */
+#define TWI_SCL_FREQUENCY 100000UL
+
+#define TWI_TWBR_VALUE(scl) (((F_CPU / (scl)) - 16) / 2)
+
+#if ((F_CPU / TWI_SCL_FREQUENCY) < 36)
+#error "TWI_SCL_FREQUENCY is too high for this F_CPU, TWBR would be less than 10"
+#elif (TWI_TWBR_VALUE(TWI_SCL_FREQUENCY) > 255)
+#error "TWI_SCL_FREQUENCY is too low for this F_CPU, TWBR exceeds 8 bits"
+#endif
 
 /*******************************************************************************
  *                      Types Definitions                                       *
@@ -39,7 +56,7 @@ typedef uint32 TWI_BaudRateType;   // Assuming baud rate can be 32-bit for highe
 // Configuration structure
 typedef struct {
     TWI_AddressType address;         // TWI address
-    TWI_BaudRateType bit_rate;       // TWI baud rate
+    TWI_BaudRateType bit_rate;       // SCL frequency in Hz
 } TWI_ConfigType;
 
 /*******************************************************************************
@@ -37,6 +37,30 @@ typedef enum {
 
 typedef uint32 UART_BaudRateType;
 
+/*
+ * Received bytes are stored by the RX complete interrupt in a ring buffer of
+ * UART_RX_BUFFER_SIZE bytes (power of 2), so no byte is lost while the
+ * application is busy and the reads can be non-blocking.
+ */
+#define UART_RX_BUFFER_SIZE 32
+
+/*
+ * Baud rate of the link between the ECUs. UART_init runs in double speed mode (U2X = 1)
+ * with the UBRR value rounded to the nearest integer, the baud rate error should stay
+ * within +/-2% for both ends to sample the bits correctly (0.2% @ 8MHz, 9600 baud).
+ */
+#define UART_BAUD_RATE 9600UL
+
+#define UART_UBRR_VALUE(baud) (((F_CPU + 4UL * (baud)) / (8UL * (baud))) - 1)
+#define UART_BAUD_ACTUAL(baud) (F_CPU / (8UL * (UART_UBRR_VALUE(baud) + 1)))
+
+#if (UART_UBRR_VALUE(UART_BAUD_RATE) > 4095)
+#error "UART_BAUD_RATE is too low for this F_CPU, UBRR exceeds 12 bits"
+#elif (((UART_BAUD_ACTUAL(UART_BAUD_RATE) * 1000UL) / UART_BAUD_RATE) > 1020) || \
+      (((UART_BAUD_ACTUAL(UART_BAUD_RATE) * 1000UL) / UART_BAUD_RATE) < 980)
+#error "UART_BAUD_RATE cannot be generated within 2% at this F_CPU"
+#endif
+
 /* Configuration structure */
 typedef struct {
     UART_BitDataType bit_data;    // Number of data bits
@@ -73,6 +97,19 @@ void UART_sendByte(const uint8 data);
  */
 uint8 UART_recieveByte(void);
 
+/*
+ * Description :
+ * Non-blocking receive: if a byte was received, store it in data and return TRUE,
+ * otherwise return FALSE immediately.
+ */
+uint8 UART_readByte(uint8 *data);
+
+/*
+ * Description :
+ * Return TRUE if a received byte is waiting in the ring buffer.
+ */
+uint8 UART_isDataAvailable(void);
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.
@@ -0,0 +1,86 @@
+/******************************************************************************
+ *
+ * Module: Work Queue
+ *
+ * File Name: work.h
+ *
+ * Description: Header file for the deferred work queue
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef WORK_H_
+#define WORK_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * The ISRs only post a work item (function + one byte argument), the main loop runs
+ * the items with WORK_process: all HIGH items first, then NORMAL, then LOW.
+ * One queue of WORK_QUEUE_SIZE - 1 items per priority (power of 2).
+ */
+#define WORK_QUEUE_SIZE               8
+
+/* Link frames of the work queue report */
+#define WORK_QUERY_FRAME              0x1C /* Request, no payload */
+#define WORK_REPORT_FRAME             0x1D /* Max interrupts disabled time in us (2 bytes), lost items (2 bytes), max items per priority (3 bytes) */
+
+#if ((WORK_QUEUE_SIZE & (WORK_QUEUE_SIZE - 1)) != 0) || (WORK_QUEUE_SIZE > 256)
+#error "WORK_QUEUE_SIZE should be a power of 2 up to 256"
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef enum
+{
+	WORK_PRIORITY_HIGH,WORK_PRIORITY_NORMAL,WORK_PRIORITY_LOW,WORK_PRIORITY_COUNT
+}WORK_PriorityType;
+
+typedef void (*WORK_FunctionType)(uint8 arg);
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Queue function(arg) to run from the main loop. Safe from the ISRs and the main loop,
+ * returns FALSE (and counts the item as lost) if the queue of this priority is full.
+ */
+uint8 WORK_post(WORK_FunctionType function, uint8 arg, WORK_PriorityType priority);
+
+/*
+ * Description :
+ * Run the queued items, highest priority first, until all the queues are empty.
+ * Call it from the main loop only.
+ */
+void WORK_process(void);
+
+/*
+ * Description :
+ * Return TRUE if any queue holds an item, used to decide whether the main loop may sleep.
+ */
+uint8 WORK_isPending(void);
+
+/*
+ * Description :
+ * Keep the worst time spent with the interrupts disabled, reported by the ISRs
+ * that measure their own duration.
+ */
+void WORK_recordIrqOff(uint32 time_us);
+
+/*
+ * Description :
+ * Send the worst interrupts disabled time, the lost items and the maximum queue
+ * occupancy over UART as a WORK_REPORT_FRAME.
+ */
+void WORK_send(void);
+
+#endif /* WORK_H_ */
@@ -0,0 +1,118 @@
+/******************************************************************************
+ *
+ * Module: Clock
+ *
+ * File Name: clock.c
+ *
+ * Description: Source file for the monotonic ms/us clock
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "clock.h"
+#include "common_macros.h"
+#include "lockfree.h" /* The ms counter is written by the tick ISR */
+#include <avr/io.h>
+#include <util/atomic.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static volatile uint32 g_clockMs = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start the clock timer in compare mode with a 1 ms period. With TIMER_DISPATCH_RUNTIME
+ * the tick handler should be set by Timer_setCallBack before.
+ */
+void Clock_init(void)
+{
+	/* Compare match every CLOCK_TICK_TOP + 1 counts = 1ms */
+	Timer_ConfigType clockConfig = {0, CLOCK_TICK_TOP, CLOCK_TIMER, CLOCK_PRESCALER_SELECT, COMPARE_MODE};
+
+	Timer_init(&clockConfig);
+}
+
+/*
+ * Description :
+ * Count one ms, should be called first in the system tick interrupt.
+ */
+void Clock_tick(void)
+{
+	g_clockMs++;
+}
+
+/*
+ * Description :
+ * Return the ms since Clock_init (wraps after 49.7 days), safe from the ISRs and the main loop.
+ */
+uint32 Clock_millis(void)
+{
+	return LF_read32(&g_clockMs);
+}
+
+/*
+ * Description :
+ * Return the us since Clock_init with the timer resolution (wraps after 71.6 minutes),
+ * safe from the ISRs and the main loop.
+ */
+uint32 Clock_micros(void)
+{
+	uint8 count;
+	uint32 ms;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		count = CLOCK_TICK_COUNTER;
+		ms = g_clockMs;
+		/* The counter was cleared by a compare match whose interrupt did not run yet */
+		if(BIT_IS_SET(TIFR, CLOCK_TICK_FLAG) && (count < (CLOCK_TICK_TOP / 2)))
+		{
+			ms++;
+		}
+	}
+	/* The product wraps together with the us, so the result stays continuous */
+	return (ms * 1000) + ((uint16)count * CLOCK_US_PER_COUNT);
+}
+
+/*
+ * Description :
+ * Return TRUE once the ms clock reached the deadline (a previous Clock_millis() + timeout).
+ */
+uint8 Clock_isExpired(uint32 deadline_ms)
+{
+	return CLOCK_IS_REACHED(Clock_millis(), deadline_ms) ? TRUE : FALSE;
+}
+
+/*
+ * Description :
+ * Return the timer count within the current ms. Read first in the tick interrupt, it
+ * marks the ISR entry before Clock_tick for Clock_elapsedUs.
+ */
+uint8 Clock_getCount(void)
+{
+	return CLOCK_TICK_COUNTER;
+}
+
+/*
+ * Description :
+ * Return the us since the timer count was read with Clock_getCount, for intervals
+ * shorter than 1 ms (e.g. the duration of an interrupt handler).
+ */
+uint16 Clock_elapsedUs(uint8 start_count)
+{
+	uint16 counts = CLOCK_TICK_COUNTER;
+
+	/* The counter went through a compare match (cleared) since the start */
+	if(counts < start_count)
+	{
+		counts += CLOCK_TICK_TOP + 1;
+	}
+	return (uint16)((counts - start_count) * CLOCK_US_PER_COUNT);
+}
@@ -0,0 +1,151 @@
+/******************************************************************************
+ *
+ * Module: Debounce
+ *
+ * File Name: debounce.c
+ *
+ * Description: Source file for the tick driven debounce service
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "debounce.h"
+#include <util/atomic.h> /* To read and clear the edges shared with the tick ISR */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef struct
+{
+	uint8 state;   /* Debounced state of the 8 inputs */
+	uint8 cnt0;    /* Bit 0 of the 8 vertical counters */
+	uint8 cnt1;    /* Bit 1 of the 8 vertical counters */
+	uint8 rising;  /* Latched 0 -> 1 changes not read yet */
+	uint8 falling; /* Latched 1 -> 0 changes not read yet */
+}DEBOUNCE_ChannelType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static volatile DEBOUNCE_ChannelType g_channels[DEBOUNCE_NUM_CHANNELS];
+static const uint8 g_channelPorts[DEBOUNCE_NUM_CHANNELS] = DEBOUNCE_CHANNEL_PORTS;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize all the channels. Port channels start with the current level of
+ * their port so no edges are reported at power up.
+ */
+void DEBOUNCE_init(void)
+{
+	uint8 channel;
+
+	for(channel = 0; channel < DEBOUNCE_NUM_CHANNELS; channel++)
+	{
+		g_channels[channel].state = (g_channelPorts[channel] == DEBOUNCE_NO_PORT) ? 0 : GPIO_readPort(g_channelPorts[channel]);
+		g_channels[channel].cnt0 = 0;
+		g_channels[channel].cnt1 = 0;
+		g_channels[channel].rising = 0;
+		g_channels[channel].falling = 0;
+	}
+}
+
+/*
+ * Description :
+ * Sample all the port channels and update their debounced state.
+ * Should be called periodically (1 kHz system tick) from the timer callback.
+ */
+void DEBOUNCE_tick(void)
+{
+	uint8 channel;
+
+	for(channel = 0; channel < DEBOUNCE_NUM_CHANNELS; channel++)
+	{
+		if(g_channelPorts[channel] != DEBOUNCE_NO_PORT)
+		{
+			DEBOUNCE_update(channel, GPIO_readPort(g_channelPorts[channel]));
+		}
+	}
+}
+
+/*
+ * Description :
+ * Feed one raw 8-bit sample to the required channel and update its debounced state.
+ */
+void DEBOUNCE_update(uint8 channel, uint8 sample)
+{
+	volatile DEBOUNCE_ChannelType *ch = &g_channels[channel];
+	uint8 state = ch->state;
+	uint8 cnt0 = ch->cnt0;
+	uint8 cnt1 = ch->cnt1;
+	uint8 delta, toggle;
+
+	/* Inputs that differ from the debounced state count up, the others reset their counter */
+	delta = sample ^ state;
+	cnt1 = (cnt1 ^ cnt0) & delta;
+	cnt0 = (uint8)(~cnt0) & delta;
+
+	/* A counter that wrapped back to zero while still different means 4 equal samples */
+	toggle = delta & (uint8)(~(cnt0 | cnt1));
+	state ^= toggle;
+
+	ch->cnt0 = cnt0;
+	ch->cnt1 = cnt1;
+	ch->state = state;
+	if(toggle)
+	{
+		ch->rising |= toggle & state;
+		ch->falling |= toggle & (uint8)(~state);
+	}
+}
+
+/*
+ * Description :
+ * Return the debounced (stable) state of the 8 inputs of the required channel.
+ */
+uint8 DEBOUNCE_getState(uint8 channel)
+{
+	return g_channels[channel].state;
+}
+
+/*
+ * Description :
+ * Return the inputs of the required channel that changed from 0 to 1 since the
+ * last call, and clear them.
+ */
+uint8 DEBOUNCE_getRisingEdges(uint8 channel)
+{
+	uint8 edges;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		edges = g_channels[channel].rising;
+		g_channels[channel].rising = 0;
+	}
+
+	return edges;
+}
+
+/*
+ * Description :
+ * Return the inputs of the required channel that changed from 1 to 0 since the
+ * last call, and clear them.
+ */
+uint8 DEBOUNCE_getFallingEdges(uint8 channel)
+{
+	uint8 edges;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		edges = g_channels[channel].falling;
+		g_channels[channel].falling = 0;
+	}
+
+	return edges;
+}
@@ -0,0 +1,91 @@
+/******************************************************************************
+ *
+ * Module: Debounce
+ *
+ * File Name: debounce.h
+ *
+ * Description: Header file for the tick driven debounce service
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include "std_types.h"
+#include "gpio.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Each channel debounces 8 inputs in parallel using 2-bit vertical counters:
+ * an input has to keep its new level for 4 consecutive samples before the
+ * stable state changes. A channel is either a whole port sampled on every
+ * DEBOUNCE_tick, or a virtual channel fed with DEBOUNCE_update by a driver
+ * that builds its own samples (e.g. the keypad matrix scan).
+ *
+ * The update of a channel is about 20 instructions and all 8 inputs share it,
+ * so a tick with two port channels stays below ~80 cycles including the port
+ * reads (about 1% of the CPU at 1 kHz with F_CPU = 8MHz).
+ */
+
+/* Used in the channel ports table for channels fed by DEBOUNCE_update */
+#define DEBOUNCE_NO_PORT                  0xFF
+
+/* Number of debounced channels */
+#define DEBOUNCE_NUM_CHANNELS             2
+
+/* Channel IDs, the keypad matrix is debounced as 16 virtual inputs (2 channels) */
+#define DEBOUNCE_KEYPAD_FIRST_CHANNEL     0
+
+/* Port sampled by each channel on every tick (in the channel IDs order) */
+#define DEBOUNCE_CHANNEL_PORTS            {DEBOUNCE_NO_PORT, DEBOUNCE_NO_PORT}
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize all the channels. Port channels start with the current level of
+ * their port so no edges are reported at power up.
+ */
+void DEBOUNCE_init(void);
+
+/*
+ * Description :
+ * Sample all the port channels and update their debounced state.
+ * Should be called periodically (1 kHz system tick) from the timer callback.
+ */
+void DEBOUNCE_tick(void);
+
+/*
+ * Description :
+ * Feed one raw 8-bit sample to the required channel and update its debounced state.
+ */
+void DEBOUNCE_update(uint8 channel, uint8 sample);
+
+/*
+ * Description :
+ * Return the debounced (stable) state of the 8 inputs of the required channel.
+ */
+uint8 DEBOUNCE_getState(uint8 channel);
+
+/*
+ * Description :
+ * Return the inputs of the required channel that changed from 0 to 1 since the
+ * last call, and clear them.
+ */
+uint8 DEBOUNCE_getRisingEdges(uint8 channel);
+
+/*
+ * Description :
+ * Return the inputs of the required channel that changed from 1 to 0 since the
+ * last call, and clear them.
+ */
+uint8 DEBOUNCE_getFallingEdges(uint8 channel);
+
+#endif /* DEBOUNCE_H_ */
@@ -9,9 +9,19 @@
 #include "UART.h"
 #include "LCD.h"
 #include "Keypad.h"
-#include <util/delay.h>
+#include <util/atomic.h>
+#include <string.h>
 #include <avr/interrupt.h>
 #include "timer.h"
+#include "debounce.h"
+#include "link.h"
+#include "trace.h"
+#include "perf.h"
+#include "stack.h"
+#include "pool.h"
+#include "work.h"
+#include "clock.h"
+#include "power.h"
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -19,10 +29,11 @@
 
 #define PASSWORD_SIZE        5
 #define MAX_TRIES            3
-#define TIMER_DELAY          15  // Delay in seconds
+#define MESSAGE_TIME_MS      500    // Short messages (saved / mismatch / door locked)
 
 // Control Command Definitions
 #define PASSWORD_SAVED       0x12
+#define DIFF_PASSWORDS       0x13
 #define TRUE_PASSWORD        0x14
 #define WRONG_PASSWORD       0x15
 #define UNLOCK_DOOR          0x18
@@ -30,26 +41,157 @@
 #define CHANGE_PASSWORD      0x20
 #define CONTROL_ECU_READY    0x16
 
+// Door status frame streamed by Control_ECU: phase, percent complete, seconds remaining, flags
+#define DOOR_STATUS_FRAME    0x01
+#define DOOR_STATUS_LENGTH   4
+#define DOOR_LOCKED          0
+#define DOOR_UNLOCKING       1
+#define DOOR_OPEN            2
+#define DOOR_LOCKING         3
+#define DOOR_LOCKOUT         4
+#define DOOR_FLAG_OCCUPIED   0x01
+
+// Startup handshake: boot status sent by Control_ECU when it starts or when asked with BOOT_QUERY_FRAME
+// payload = boot state, TRUE if waiting for a password, Control_ECU ready time in us (4 bytes)
+#define BOOT_QUERY_FRAME     0x02
+#define BOOT_STATUS_FRAME    0x03
+#define BOOT_STATUS_LENGTH   6
+#define BOOT_SETUP           0      // No valid password saved, create one
+#define BOOT_PROVISIONED     1      // Password saved, go straight to the menu
+#define BOOT_QUERY_PERIOD_MS 200    // The query is repeated until Control_ECU answers
+
 /*******************************************************************************
- *                           Global Variables                                  *
+ *                               Types Declaration                             *
  *******************************************************************************/
 
-static volatile uint8 g_ticks = 0;
-/* Create configuration structure for timer driver */
+typedef enum {
+    SCREEN_BOOT,          // "Door Lock System" until Control_ECU sends its boot status
+    SCREEN_NEW_PASS,      // Enter the new password
+    SCREEN_CONFIRM_PASS,  // Re-enter the new password
+    SCREEN_SAVING,        // Waiting for Control_ECU to compare and save the new password
+    SCREEN_SAVED,         // "successfully"
+    SCREEN_MISMATCH,      // "Mismatch"
+    SCREEN_MENU,          // Door options
+    SCREEN_ENTER_PASS,    // Enter the password for the selected option
+    SCREEN_CHECKING,      // Waiting for Control_ECU to check the password
+    SCREEN_UNLOCKING,     // "Door Unlocking" with the progress
+    SCREEN_WAIT_PEOPLE,   // "Wait for people" with the time left before locking
+    SCREEN_LOCKING,       // "Door Locking" with the progress
+    SCREEN_DOOR_LOCKED,   // "Door Locked"
+    SCREEN_LOCKED,        // "System LOCKED" after MAX_TRIES wrong passwords
+    SCREEN_COUNT,
+    SCREEN_SAME = SCREEN_COUNT  // Returned by a handler to stay on the current screen
+} Screen_IdType;
+
+/*
+ * A screen is a table of handlers, any of them can be NULL_PTR (event ignored).
+ * Handlers return the next screen and finish in bounded time, the main loop calls
+ * them as the events arrive so the UI never waits.
+ */
+typedef struct {
+    void (*enter)(void);                  // Draw the screen, start its timer
+    Screen_IdType (*onKey)(uint8 key);    // Key pressed
+    Screen_IdType (*onLink)(uint8 data);  // Byte received from Control_ECU
+    Screen_IdType (*onTimer)(void);       // Screen timer expired
+    Screen_IdType (*onStatus)(void);      // Door status frame received (g_doorStatus)
+} Screen_Type;
+
+typedef struct {
+    uint8 phase;
+    uint8 percent;
+    uint8 seconds;
+    uint8 flags;
+} DoorStatus_Type;
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
-void createPassword(void);
-void getPassword(uint8* pass, uint8 size);
-uint8 checkPassword(void);
-void alarmMode(void);
-void Timer1_DelaySecond(uint8 time);
-void countOneSecond(void);
-void displayDoorOptions(void);
-void handleDoorUnlock(void);
-void handlePasswordChange(void);
+static void systemTick(void);  // Static so the compiler can inline it into the timer ISR
+void screenTimerWork(uint8 timerId);
+void startScreenTimer(uint16 time_ms);
+void showScreen(Screen_IdType screen);
+void queuePassword(const uint8 *pass, uint8 offset);
+void handleFrame(void);
+void showDoorProgress(const char *label);
+Screen_IdType passwordKey(uint8 key, Screen_IdType done);
+
+void enterBoot(void);
+void enterNewPass(void);
+void enterConfirmPass(void);
+void enterSaved(void);
+void enterMismatch(void);
+void enterMenu(void);
+void enterPass(void);
+void enterUnlocking(void);
+void enterWaitPeople(void);
+void enterLocking(void);
+void enterDoorLocked(void);
+void enterLocked(void);
+Screen_IdType bootQuery(void);
+Screen_IdType newPassKey(uint8 key);
+Screen_IdType confirmPassKey(uint8 key);
+Screen_IdType savingLink(uint8 data);
+Screen_IdType showMenu(void);
+Screen_IdType showNewPass(void);
+Screen_IdType menuKey(uint8 key);
+Screen_IdType enterPassKey(uint8 key);
+Screen_IdType checkingLink(uint8 data);
+Screen_IdType doorLink(uint8 data);
+Screen_IdType unlockingStatus(void);
+Screen_IdType waitPeopleStatus(void);
+Screen_IdType lockingStatus(void);
+Screen_IdType lockedStatus(void);
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* In the Screen_IdType order */
+static const Screen_Type g_screens[SCREEN_COUNT] = {
+    /*                    enter             onKey           onLink        onTimer      onStatus         */
+    /* BOOT         */ {enterBoot,        NULL_PTR,       NULL_PTR,     bootQuery,   NULL_PTR},
+    /* NEW_PASS     */ {enterNewPass,     newPassKey,     NULL_PTR,     NULL_PTR,    NULL_PTR},
+    /* CONFIRM_PASS */ {enterConfirmPass, confirmPassKey, NULL_PTR,     NULL_PTR,    NULL_PTR},
+    /* SAVING       */ {NULL_PTR,         NULL_PTR,       savingLink,   NULL_PTR,    NULL_PTR},
+    /* SAVED        */ {enterSaved,       NULL_PTR,       NULL_PTR,     showMenu,    NULL_PTR},
+    /* MISMATCH     */ {enterMismatch,    NULL_PTR,       NULL_PTR,     showNewPass, NULL_PTR},
+    /* MENU         */ {enterMenu,        menuKey,        NULL_PTR,     NULL_PTR,    NULL_PTR},
+    /* ENTER_PASS   */ {enterPass,        enterPassKey,   NULL_PTR,     NULL_PTR,    NULL_PTR},
+    /* CHECKING     */ {NULL_PTR,         NULL_PTR,       checkingLink, NULL_PTR,    NULL_PTR},
+    /* UNLOCKING    */ {enterUnlocking,   NULL_PTR,       NULL_PTR,     NULL_PTR,    unlockingStatus},
+    /* WAIT_PEOPLE  */ {enterWaitPeople,  NULL_PTR,       doorLink,     NULL_PTR,    waitPeopleStatus},
+    /* LOCKING      */ {enterLocking,     NULL_PTR,       NULL_PTR,     NULL_PTR,    lockingStatus},
+    /* DOOR_LOCKED  */ {enterDoorLocked,  NULL_PTR,       NULL_PTR,     showMenu,    NULL_PTR},
+    /* LOCKED       */ {enterLocked,      NULL_PTR,       NULL_PTR,     NULL_PTR,    lockedStatus}
+};
+
+static Screen_IdType g_screen = SCREEN_BOOT;
+
+/*
+ * Screen timer in ms counted down by the system tick, the expiry is posted to the work queue
+ * with the timer ID: an expiry still queued when the timer is restarted is ignored.
+ */
+static volatile uint16 g_screenTimer = 0;
+static volatile uint8 g_screenTimerId = 0;
+
+/* Password being typed and the password(s) to send */
+static uint8 g_pass[PASSWORD_SIZE + 1];
+static uint8 g_passLength = 0;
+static uint8 g_txPasswords[2 * (PASSWORD_SIZE + 1) + 1];
+static uint8 g_txPending = FALSE;
+
+/* Control_ECU sent CONTROL_ECU_READY and waits for the password(s) */
+static uint8 g_controlReady = FALSE;
+
+/* Last door status received from Control_ECU: the payload of the last status frame, kept in its pool block */
+static const DoorStatus_Type g_defaultStatus = {DOOR_LOCKED, 100, 0, 0};
+static const DoorStatus_Type *g_doorStatus = &g_defaultStatus;
+static LINK_FrameType *g_statusFrame = NULL_PTR;
+
+/* Selected door option (UNLOCK_DOOR or CHANGE_PASSWORD) and the wrong attempts in a row */
+static uint8 g_action = 0;
+static uint8 g_attempts = 0;
 
 /*******************************************************************************
  *                                    Main                                     *
@@ -57,28 +199,72 @@ void handlePasswordChange(void);
 
 int main(void) {
     uint8 key;
+    uint8 data;
+
+    UART_ConfigType uartConfig = {EIGHT_BITS, NO_PARITY, ONE_STOP_BIT, UART_BAUD_RATE};
 
-    UART_ConfigType uartConfig = {EIGHT_BITS, NO_PARITY, ONE_STOP_BIT, 9600};
     sei();  // Enable Global Interrupt
+    POOL_init();  // Initialize the buffer pool used by the link input
     UART_init(&uartConfig);  // Initialize UART
+
+    DEBOUNCE_init();  // Initialize the debounce service
+    KEYPAD_init();  // Initialize the keypad scan
+#if (TIMER0_DISPATCH == TIMER_DISPATCH_RUNTIME)
+    Timer_setCallBack(systemTick, TIMER0);
+#endif
+    Clock_init();  // Start the clock first so the boot time includes the LCD start-up
+    POWER_init();  // The main loop sleeps in idle mode when it has nothing to do
     LCD_init();  // Initialize LCD
 
-    LCD_displayString("Door Lock System");
-    _delay_ms(500);
-    createPassword();  // Create initial password
-    LCD_clearScreen();
+    // Wait for the boot status of Control_ECU: main menu if a password is saved, else create one
+    showScreen(SCREEN_BOOT);
 
     for (;;) {
-        displayDoorOptions();
+        // Key events
+        key = KEYPAD_getKey();
+        if (key != KEYPAD_NO_KEY) {
+            POWER_eventHandled();
+            TRACE_POINT(TRACE_KEY_PRESSED, key);
+            PERF_COUNT(PERF_KEY_EVENTS);
+            if (g_screens[g_screen].onKey != NULL_PTR) {
+                showScreen(g_screens[g_screen].onKey(key));
+            }
+        }
 
-        key = KEYPAD_getPressedKey();
-        _delay_ms(500);
+        // Link events, CONTROL_ECU_READY and the frames are handled here for all the screens
+        while (UART_readByte(&data)) {
+            LINK_ParseResultType result;
+
+            POWER_eventHandled();
+            result = LINK_parseByte(data);
+            if (result == LINK_FRAME_READY) {
+                handleFrame();
+            } else if (result == LINK_FRAME_BUSY) {
+                // Byte taken by the frame parser
+            } else if (data == CONTROL_ECU_READY) {
+                TRACE_POINT(TRACE_LINK_RX, data);
+                g_controlReady = TRUE;
+            } else {
+                TRACE_POINT(TRACE_LINK_RX, data);
+                if (g_screens[g_screen].onLink != NULL_PTR) {
+                    showScreen(g_screens[g_screen].onLink(data));
+                }
+            }
+        }
 
-        if (key == '+') {
-            handleDoorUnlock();
-        } else if (key == '-') {
-            handlePasswordChange();
+        // Send the typed password(s) as soon as Control_ECU is ready for them
+        if (g_txPending && g_controlReady) {
+            g_txPending = FALSE;
+            g_controlReady = FALSE;
+            UART_sendString(g_txPasswords);
+            TRACE_POINT(TRACE_LINK_TX, (uint8)strlen((char*)g_txPasswords));
         }
+
+        // Events posted by the interrupts (screen timer)
+        WORK_process();
+
+        // Nothing left to do: sleep until the next interrupt, the 1 kHz tick also scans the keypad
+        POWER_SLEEP_UNLESS(UART_isDataAvailable() || WORK_isPending());
     }
 }
 
@@ -86,149 +272,351 @@ int main(void) {
  *                         Functions Definitions                               *
  *******************************************************************************/
 
-/* Display options for the user to interact with the door system */
-void displayDoorOptions(void) {
-    LCD_displayString("+ : Open Door");
-    LCD_displayStringRowColumn(1, 0, "- : Change Pass");
+/* Change the current screen (stopping the timer of the old one) and draw it */
+void showScreen(Screen_IdType screen) {
+    if (screen == SCREEN_SAME) {
+        return;
+    }
+    startScreenTimer(0);
+    g_screen = screen;
+    if (g_screens[screen].enter != NULL_PTR) {
+        g_screens[screen].enter();
+        TRACE_POINT(TRACE_LCD_FLUSH, screen);
+    }
+}
+
+/* Start the screen timer, the onTimer handler is called after time_ms (0 stops the timer) */
+void startScreenTimer(uint16 time_ms) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        g_screenTimer = time_ms;
+        g_screenTimerId++;
+    }
 }
 
-/* Handle door unlocking process */
-void handleDoorUnlock(void) {
-    uint8 isPassTrue = checkPassword();
+/* Screen timer expired, posted by the system tick */
+void screenTimerWork(uint8 timerId) {
+    POWER_eventHandled();
+    if ((timerId == g_screenTimerId) && (g_screens[g_screen].onTimer != NULL_PTR)) {
+        showScreen(g_screens[g_screen].onTimer());
+    }
+}
 
-    if (isPassTrue == TRUE_PASSWORD) {
-        UART_sendByte(UNLOCK_DOOR);  // Send unlock signal
-        LCD_clearScreen();
-        LCD_displayString("Door Unlocking");
-        LCD_displayStringRowColumn(1, 0, "Please wait...");
-        Timer1_DelaySecond(TIMER_DELAY);
-        LCD_clearScreen();
-        LCD_displayString("Wait for people");
-        LCD_displayStringRowColumn(1, 0, "to enter");
+/* Handle a frame: door status from Control_ECU, debug requests (trace, counters, SRAM) from a host */
+void handleFrame(void) {
+    LINK_FrameType *frame = LINK_getFrame();
+
+    if (frame->type == TRACE_DUMP_REQUEST_FRAME) {
+        TRACE_dump();
+    } else if (frame->type == PERF_QUERY_FRAME) {
+        PERF_send();
+    } else if (frame->type == STACK_QUERY_FRAME) {
+        STACK_send();
+    } else if (frame->type == POOL_QUERY_FRAME) {
+        POOL_send();
+    } else if (frame->type == WORK_QUERY_FRAME) {
+        WORK_send();
+    } else if (frame->type == POWER_QUERY_FRAME) {
+        POWER_send();
+    } else if ((frame->type == BOOT_STATUS_FRAME) && (frame->length == BOOT_STATUS_LENGTH)) {
+        // Control_ECU started (or answered the query): restart from the screen matching its state
+        g_txPending = FALSE;
+        g_controlReady = frame->payload[1];
+        if (g_screen == SCREEN_BOOT) {
+            TRACE_POINT(TRACE_BOOT_DONE, (frame->payload[0] == BOOT_PROVISIONED) ? SCREEN_MENU : SCREEN_NEW_PASS);
+        }
+        showScreen((frame->payload[0] == BOOT_PROVISIONED) ? SCREEN_MENU : SCREEN_NEW_PASS);
+    } else if ((frame->type == DOOR_STATUS_FRAME) && (frame->length == DOOR_STATUS_LENGTH)) {
+        // Keep this frame as the current status and release the previous one
+        LINK_freeFrame(g_statusFrame);
+        g_statusFrame = frame;
+        g_doorStatus = (const DoorStatus_Type *)frame->payload;
+        if (g_screens[g_screen].onStatus != NULL_PTR) {
+            showScreen(g_screens[g_screen].onStatus());
+        }
+        return;
+    }
+    LINK_freeFrame(frame);
+}
 
-        // Wait for the door locking signal
-        while (UART_recieveByte() != LOCKING_DOOR)
-            _delay_ms(50);
+/* Show the status on the second line as "<label> NNNs  PPP%" (fixed width, no clear needed) */
+void showDoorProgress(const char *label) {
+    char line[17];
+    uint8 i = 0;
+    uint8 seconds = g_doorStatus->seconds;
+    uint8 percent = g_doorStatus->percent;
 
-        LCD_clearScreen();
-        LCD_displayStringRowColumn(0, 0, "Door Locked");
-        Timer1_DelaySecond(TIMER_DELAY);
-        LCD_clearScreen();
-    } else if (isPassTrue == WRONG_PASSWORD) {
-        alarmMode();
+    while ((*label != '\0') && (i < 6)) {
+        line[i++] = *label++;
+    }
+    while (i < 6) {
+        line[i++] = ' ';
     }
+    line[i++] = (seconds >= 100) ? ('0' + seconds / 100) : ' ';
+    line[i++] = (seconds >= 10) ? ('0' + (seconds / 10) % 10) : ' ';
+    line[i++] = '0' + seconds % 10;
+    line[i++] = 's';
+    line[i++] = ' ';
+    line[i++] = ' ';
+    line[i++] = (percent >= 100) ? '1' : ' ';
+    line[i++] = (percent >= 10) ? ('0' + (percent / 10) % 10) : ' ';
+    line[i++] = '0' + percent % 10;
+    line[i++] = '%';
+    line[i] = '\0';
+    LCD_displayStringRowColumn(1, 0, line);
 }
 
-/* Handle password change process */
-void handlePasswordChange(void) {
-    uint8 isPassTrue = checkPassword();
+/* Queue the password (terminated by '#') to be sent when Control_ECU is ready */
+void queuePassword(const uint8 *pass, uint8 offset) {
+    uint8 i;
+    for (i = 0; i < PASSWORD_SIZE; i++) {
+        g_txPasswords[offset + i] = pass[i] + 48;  // Convert to ASCII
+    }
+    g_txPasswords[offset + i++] = '#';
+    g_txPasswords[offset + i] = '\0';
+}
 
-    if (isPassTrue == TRUE_PASSWORD) {
-        UART_sendByte(CHANGE_PASSWORD);
-        createPassword();
-        LCD_clearScreen();
-    } else if (isPassTrue == WRONG_PASSWORD) {
-    		alarmMode();
+/*
+ * Collect the password digits of the entry screens: a digit is shown as '*',
+ * '=' after PASSWORD_SIZE digits completes the password and returns the done screen.
+ */
+Screen_IdType passwordKey(uint8 key, Screen_IdType done) {
+    if ((key <= 9) && (g_passLength < PASSWORD_SIZE)) {
+        g_pass[g_passLength++] = key;
+        LCD_displayCharacter('*');
+    } else if ((key == '=') && (g_passLength == PASSWORD_SIZE)) {
+        TRACE_POINT(TRACE_PASSWORD_ENTERED, g_screen);
+        return done;
     }
+    return SCREEN_SAME;
 }
 
-/* Check the entered password against the saved password */
-uint8 checkPassword(void) {
-    uint8 pass[PASSWORD_SIZE + 2];
-    uint8 attempts;
+/*******************************************************************************
+ *                         Screens                                             *
+ *******************************************************************************/
 
-    for (attempts = 0; attempts < MAX_TRIES; attempts++) {
-        LCD_clearScreen();
-        LCD_displayString("Enter Password:");
-        LCD_moveCursor(1, 0);
+/* Boot screen until Control_ECU sends its boot status, the query is repeated every BOOT_QUERY_PERIOD_MS */
+void enterBoot(void) {
+    LCD_clearScreen();
+    LCD_displayString("Door Lock System");
+    bootQuery();
+}
 
-        getPassword(pass, PASSWORD_SIZE + 2);  // Capture user input
-        while (KEYPAD_getPressedKey() != '=');
-        _delay_ms(500);
+Screen_IdType bootQuery(void) {
+    LINK_sendFrame(BOOT_QUERY_FRAME, NULL_PTR, 0);
+    startScreenTimer(BOOT_QUERY_PERIOD_MS);
+    return SCREEN_SAME;
+}
 
-        while (UART_recieveByte() != CONTROL_ECU_READY);
-        UART_sendString(pass);  // Send password for verification
+/* Create a new password (new password is confirmed by re-entering) */
+void enterNewPass(void) {
+    g_passLength = 0;
+    LCD_clearScreen();
+    LCD_displayStringRowColumn(0, 0, "Enter New Pass: ");
+    LCD_moveCursor(1, 0);
+}
 
-        uint8 flag = UART_recieveByte();
-        if (flag == TRUE_PASSWORD) {
-            return TRUE_PASSWORD;
-        }// Correct password
+Screen_IdType newPassKey(uint8 key) {
+    Screen_IdType next = passwordKey(key, SCREEN_CONFIRM_PASS);
+    if (next == SCREEN_CONFIRM_PASS) {
+        queuePassword(g_pass, 0);
     }
-    return WRONG_PASSWORD;  // If max attempts reached
+    return next;
 }
 
-/* Alarm Mode - Locks system for 1 minute after 3 failed password attempts */
-void alarmMode(void) {
+void enterConfirmPass(void) {
+    g_passLength = 0;
     LCD_clearScreen();
-    LCD_displayString("System LOCKED");
-    LCD_displayStringRowColumn(1, 0, "Wait for 1 min");
-    Timer1_DelaySecond(60);  // Lock the system for 60 seconds
+    LCD_displayStringRowColumn(0, 0, "Re-enter Pass: ");
+    LCD_moveCursor(1, 0);
+}
+
+Screen_IdType confirmPassKey(uint8 key) {
+    Screen_IdType next = passwordKey(key, SCREEN_SAVING);
+    if (next == SCREEN_SAVING) {
+        // Both passwords are sent together, Control_ECU compares them
+        queuePassword(g_pass, PASSWORD_SIZE + 1);
+        g_txPending = TRUE;
+    }
+    return next;
+}
+
+Screen_IdType savingLink(uint8 data) {
+    if (data == PASSWORD_SAVED) {
+        return SCREEN_SAVED;
+    } else if (data == DIFF_PASSWORDS) {
+        return SCREEN_MISMATCH;
+    }
+    return SCREEN_SAME;
+}
+
+void enterSaved(void) {
     LCD_clearScreen();
+    LCD_displayStringRowColumn(0, 0, "successfully");
+    startScreenTimer(MESSAGE_TIME_MS);
 }
 
-/* Create a new password (new password is confirmed by re-entering) */
-void createPassword(void) {
-    uint8 pass1[PASSWORD_SIZE + 2], pass2[PASSWORD_SIZE + 2];
-    uint8 isSaved;
+void enterMismatch(void) {
+    LCD_clearScreen();
+    LCD_displayStringRowColumn(0, 0, "Mismatch");
+    startScreenTimer(MESSAGE_TIME_MS);
+}
 
-    for (;;) {
-        LCD_clearScreen();
-        LCD_displayStringRowColumn(0, 0, "Enter New Pass: ");
-        LCD_moveCursor(1, 0);
-
-        getPassword(pass1, PASSWORD_SIZE + 2);
-        while (KEYPAD_getPressedKey() != '=');
-        _delay_ms(500);
-
-        LCD_clearScreen();
-        LCD_displayStringRowColumn(0, 0, "Re-enter Pass: ");
-        LCD_moveCursor(1, 0);
-        getPassword(pass2, PASSWORD_SIZE + 2);
-        while (KEYPAD_getPressedKey() != '=');
-        _delay_ms(500);
-
-        while (UART_recieveByte() != CONTROL_ECU_READY);
-        UART_sendString(pass1);
-        UART_sendString(pass2);
-
-        isSaved = UART_recieveByte();
-        if (isSaved == PASSWORD_SAVED) {
-        	LCD_clearScreen();
-        	LCD_displayStringRowColumn(0, 0, "successfully");
-        	_delay_ms(500);
-            return;  // Return if password is successfully saved
-        }
-    	LCD_clearScreen();
-    	LCD_displayStringRowColumn(0, 0, "Mismatch");
-    	_delay_ms(500);
+Screen_IdType showMenu(void) {
+    return SCREEN_MENU;
+}
+
+Screen_IdType showNewPass(void) {
+    return SCREEN_NEW_PASS;
+}
+
+/* Display options for the user to interact with the door system */
+void enterMenu(void) {
+    g_attempts = 0;
+    LCD_clearScreen();
+    LCD_displayString("+ : Open Door");
+    LCD_displayStringRowColumn(1, 0, "- : Change Pass");
+}
+
+Screen_IdType menuKey(uint8 key) {
+    if (key == '+') {
+        g_action = UNLOCK_DOOR;
+        return SCREEN_ENTER_PASS;
+    } else if (key == '-') {
+        g_action = CHANGE_PASSWORD;
+        return SCREEN_ENTER_PASS;
     }
+    return SCREEN_SAME;
 }
 
-/* Capture password input from user and append necessary characters */
-void getPassword(uint8* pass, uint8 size) {
-    uint8 i;
-    for (i = 0; i < size - 2; i++) {
-        pass[i] = KEYPAD_getPressedKey() + 48;  // Convert to ASCII
-        LCD_displayCharacter('*');
-        _delay_ms(500);
+/* Check the entered password against the saved password */
+void enterPass(void) {
+    g_passLength = 0;
+    LCD_clearScreen();
+    LCD_displayString("Enter Password:");
+    LCD_moveCursor(1, 0);
+}
+
+Screen_IdType enterPassKey(uint8 key) {
+    Screen_IdType next = passwordKey(key, SCREEN_CHECKING);
+    if (next == SCREEN_CHECKING) {
+        PERF_COUNT(PERF_PASSWORD_ATTEMPTS);
+        queuePassword(g_pass, 0);
+        g_txPending = TRUE;
+    }
+    return next;
+}
+
+Screen_IdType checkingLink(uint8 data) {
+    if (data == TRUE_PASSWORD) {
+        UART_sendByte(g_action);  // Send the selected option
+        return (g_action == UNLOCK_DOOR) ? SCREEN_UNLOCKING : SCREEN_NEW_PASS;
+    } else if (data == WRONG_PASSWORD) {
+        // Alarm Mode - Locks system for 1 minute after 3 failed password attempts
+        return (++g_attempts >= MAX_TRIES) ? SCREEN_LOCKED : SCREEN_ENTER_PASS;
+    }
+    return SCREEN_SAME;
+}
+
+/*
+ * Door unlocking, waiting for people to enter, then locking: the screens follow the
+ * status frames of Control_ECU, the status sent before the unlock command is ignored.
+ */
+void enterUnlocking(void) {
+    LCD_clearScreen();
+    LCD_displayString("Door Unlocking");
+    LCD_displayStringRowColumn(1, 0, "Please wait...");
+}
+
+Screen_IdType unlockingStatus(void) {
+    if (g_doorStatus->phase == DOOR_UNLOCKING) {
+        showDoorProgress("Open");
+    } else if (g_doorStatus->phase == DOOR_OPEN) {
+        return SCREEN_WAIT_PEOPLE;
+    } else if (g_doorStatus->phase == DOOR_LOCKING) {
+        return SCREEN_LOCKING;
+    }
+    return SCREEN_SAME;
+}
+
+void enterWaitPeople(void) {
+    LCD_clearScreen();
+    LCD_displayString("Wait for people");
+}
+
+Screen_IdType waitPeopleStatus(void) {
+    if (g_doorStatus->phase == DOOR_OPEN) {
+        // Time before locking, restarted by every motion
+        showDoorProgress((g_doorStatus->flags & DOOR_FLAG_OCCUPIED) ? "Busy" : "Lock");
+    } else if (g_doorStatus->phase == DOOR_LOCKING) {
+        return SCREEN_LOCKING;
+    } else if (g_doorStatus->phase == DOOR_LOCKED) {
+        return SCREEN_DOOR_LOCKED;
+    }
+    return SCREEN_SAME;
+}
+
+Screen_IdType doorLink(uint8 data) {
+    return (data == LOCKING_DOOR) ? SCREEN_LOCKING : SCREEN_SAME;
+}
+
+void enterLocking(void) {
+    LCD_clearScreen();
+    LCD_displayString("Door Locking");
+}
+
+Screen_IdType lockingStatus(void) {
+    if (g_doorStatus->phase == DOOR_LOCKING) {
+        showDoorProgress("Close");
+    } else if (g_doorStatus->phase == DOOR_LOCKED) {
+        return SCREEN_DOOR_LOCKED;
     }
-    pass[i++] = '#';
-    pass[i] = '\0';
+    return SCREEN_SAME;
 }
 
-/* Timer callback function to count 1 second */
-void countOneSecond(void) {
-    g_ticks++;  // Increment ticks every 1 second
+void enterDoorLocked(void) {
+    LCD_clearScreen();
+    LCD_displayStringRowColumn(0, 0, "Door Locked");
+    startScreenTimer(MESSAGE_TIME_MS);
+}
+
+void enterLocked(void) {
+    PERF_COUNT(PERF_LOCKOUTS);
+    LCD_clearScreen();
+    LCD_displayString("System LOCKED");
+    LCD_displayStringRowColumn(1, 0, "Wait for 1 min");
+}
+
+Screen_IdType lockedStatus(void) {
+    if (g_doorStatus->phase == DOOR_LOCKOUT) {
+        showDoorProgress("Wait");
+    } else if (g_doorStatus->phase == DOOR_LOCKED) {
+        // Control_ECU ended the lockout
+        return SCREEN_MENU;
+    }
+    return SCREEN_SAME;
 }
 
-/* Delay function to wait for a specified number of seconds */
-void Timer1_DelaySecond(uint8 time) {
-    Timer_ConfigType timerConfig = {0, 31249, TIMER1, CLOCK_256, COMPARE_MODE};
-    Timer_setCallBack(countOneSecond, TIMER1);
-    Timer_init(&timerConfig);  // Initialize timer
+/*******************************************************************************
+ *                         Interrupt Callbacks                                 *
+ *******************************************************************************/
+
+/*
+ * System tick callback (1 kHz), counts the clock, scans one keypad row every tick and counts
+ * the screen timer. Its duration from the ISR entry (the longest time with the interrupts
+ * disabled) goes to the work queue.
+ */
+static void systemTick(void) {
+    uint8 start = Clock_getCount();  // Read before anything else so the clock update is measured too
 
-    // Wait for the specified time (in seconds)
-    while (g_ticks < time);
-    g_ticks = 0;  // Reset tick counter
-    Timer_deInit(TIMER1);  // Stop the timer
+    Clock_tick();  // The clock is only valid once this tick is counted
+    KEYPAD_tick();
+    if ((g_screenTimer != 0) && (--g_screenTimer == 0)) {
+        WORK_post(screenTimerWork, g_screenTimerId, WORK_PRIORITY_NORMAL);
+    }
+    WORK_recordIrqOff(Clock_elapsedUs(start));
 }
+
+#if (TIMER0_DISPATCH == TIMER_DISPATCH_STATIC)
+// The system tick is bound to the Timer0 compare interrupt at compile time
+TIMER_BIND_HANDLER(TIMER0_COMP_vect, systemTick)
+#endif
@@ -12,12 +12,18 @@
 *******************************************************************************/
 #include "keypad.h"
 #include "GPIO.h"
-#include <util/delay.h>
+#include "debounce.h"
+#include "power.h" /* To sleep while waiting for a key */
 
 /*******************************************************************************
  *                      Functions Prototypes(Private)                          *
  *******************************************************************************/
 
+/*
+ * Function responsible for making the required row the only output row of the keypad
+ */
+static void KEYPAD_driveRow(uint8 row);
+
 #if (KEYPAD_NUM_COLS == 3)
 /*
  * Function responsible for mapping the switch number in the keypad to
@@ -32,53 +38,131 @@ static uint8 KEYPAD_4x3_adjustKeyNumber(uint8 button_number);
 static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
 #endif
 
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Row sampled on the next tick and the pressed keys collected in the current scan */
+static uint8 g_scanRow = 0;
+static uint16 g_scanImage = 0;
+
+/* Debounced key presses not returned yet by KEYPAD_getKey */
+static uint16 g_pendingKeys = 0;
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
 
-uint8 KEYPAD_getPressedKey(void)
+/*
+ * Description :
+ * Make the required row the only output row and drive it to the pressed level.
+ */
+static void KEYPAD_driveRow(uint8 row)
 {
-	uint8 col,row;
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+1, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+2, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+3, PIN_INPUT);
-
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+1, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+2, PIN_INPUT);
-#if(KEYPAD_NUM_COLS == 4)
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+3, PIN_INPUT);
+	/* All the keypad rows are input pins except this row (one port update for all the rows) */
+	GPIO_setupPortDirectionMasked(KEYPAD_ROW_PORT_ID, KEYPAD_ROWS_MASK, (1 << (KEYPAD_FIRST_ROW_PIN_ID+row)));
+
+	/* Set/Clear the row output pin */
+	GPIO_writePinFast(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, KEYPAD_BUTTON_PRESSED);
+}
+
+/*
+ * Description :
+ * Initialize the keypad pins and start the tick driven matrix scan.
+ */
+void KEYPAD_init(void)
+{
+	/* Setup all the row and column pins as input pins */
+	GPIO_setupPortDirectionMasked(KEYPAD_ROW_PORT_ID, KEYPAD_ROWS_MASK, PORT_INPUT);
+	GPIO_setupPortDirectionMasked(KEYPAD_COL_PORT_ID, KEYPAD_COLS_MASK, PORT_INPUT);
+
+	g_scanRow = 0;
+	g_scanImage = 0;
+	g_pendingKeys = 0;
+
+	/* The first row is sampled on the next tick */
+	KEYPAD_driveRow(g_scanRow);
+}
+
+/*
+ * Description :
+ * Scan one keypad row, should be called from the 1 kHz system tick.
+ * A full matrix scan takes KEYPAD_NUM_ROWS ticks, then all the keys are
+ * debounced together by the debounce service.
+ */
+void KEYPAD_tick(void)
+{
+	uint8 cols_state;
+
+	/* Sample all the columns of the row driven on the previous tick (it had a whole tick to settle) */
+	cols_state = GPIO_readPortMasked(KEYPAD_COL_PORT_ID, KEYPAD_COLS_MASK) >> KEYPAD_FIRST_COL_PIN_ID;
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	cols_state = (uint8)(~cols_state) & ((1 << KEYPAD_NUM_COLS) - 1);
 #endif
-	while(1)
+
+	/* Key (row*KEYPAD_NUM_COLS)+col is bit number (row*KEYPAD_NUM_COLS)+col in the scan image */
+	g_scanImage |= (uint16)cols_state << (g_scanRow * KEYPAD_NUM_COLS);
+
+	g_scanRow++;
+	if(g_scanRow == KEYPAD_NUM_ROWS)
+	{
+		/* Full matrix scanned, debounce all the keys at once */
+		DEBOUNCE_update(DEBOUNCE_KEYPAD_FIRST_CHANNEL, (uint8)g_scanImage);
+		DEBOUNCE_update(DEBOUNCE_KEYPAD_FIRST_CHANNEL + 1, (uint8)(g_scanImage >> 8));
+		g_scanImage = 0;
+		g_scanRow = 0;
+	}
+
+	KEYPAD_driveRow(g_scanRow);
+}
+
+/*
+ * Description :
+ * Return the next debounced key press or KEYPAD_NO_KEY if there is none (non-blocking).
+ * Every physical press is reported once, holding a key does not repeat it.
+ */
+uint8 KEYPAD_getKey(void)
+{
+	uint8 button;
+
+	/* Collect the new press events, they are kept until returned one by one */
+	g_pendingKeys |= DEBOUNCE_getRisingEdges(DEBOUNCE_KEYPAD_FIRST_CHANNEL);
+	g_pendingKeys |= (uint16)DEBOUNCE_getRisingEdges(DEBOUNCE_KEYPAD_FIRST_CHANNEL + 1) << 8;
+
+	for(button = 0; button < (KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS); button++)
 	{
-		for(row=0 ; row<KEYPAD_NUM_ROWS ; row++) /* loop for rows */
+		if(g_pendingKeys & ((uint16)1 << button))
 		{
-			/* 
-			 * Each time setup the direction for all keypad port as input pins,
-			 * except this row will be output pin
-			 */
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_OUTPUT);
-
-			/* Set/Clear the row output pin */
-			GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, KEYPAD_BUTTON_PRESSED);
-
-			for(col=0 ; col<KEYPAD_NUM_COLS ; col++) /* loop for columns */
-			{
-				/* Check if the switch is pressed in this column */
-				if(GPIO_readPin(KEYPAD_COL_PORT_ID,KEYPAD_FIRST_COL_PIN_ID+col) == KEYPAD_BUTTON_PRESSED)
-				{
-					#if (KEYPAD_NUM_COLS == 3)
-						return KEYPAD_4x3_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-					#elif (KEYPAD_NUM_COLS == 4)
-						return KEYPAD_4x4_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-					#endif
-				}
-			}
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_INPUT);
-			_delay_ms(10); /* Add small delay to fix CPU load issue in proteus */
+			g_pendingKeys &= ~((uint16)1 << button);
+#if (KEYPAD_NUM_COLS == 3)
+			return KEYPAD_4x3_adjustKeyNumber(button+1);
+#elif (KEYPAD_NUM_COLS == 4)
+			return KEYPAD_4x4_adjustKeyNumber(button+1);
+#endif
 		}
-	}	
+	}
+
+	return KEYPAD_NO_KEY;
+}
+
+/*
+ * Description :
+ * Wait for the next debounced key press and return the pressed button.
+ */
+uint8 KEYPAD_getPressedKey(void)
+{
+	uint8 key;
+
+	key = KEYPAD_getKey();
+	while(key == KEYPAD_NO_KEY)
+	{
+		/* The keys are scanned by the 1 kHz tick interrupt, which wakes the CPU up.
+		 * A press found by a tick just before the sleep is returned one tick later. */
+		POWER_SLEEP_UNLESS(FALSE);
+		key = KEYPAD_getKey();
+	}
+
+	return key;
 }
 
 #if (KEYPAD_NUM_COLS == 3)
@@ -30,17 +30,45 @@
 #define KEYPAD_COL_PORT_ID                PORTB_ID
 #define KEYPAD_FIRST_COL_PIN_ID           PIN4_ID
 
+/* Masks of the row and column pins, used to update/sample each group in one port access */
+#define KEYPAD_ROWS_MASK                  (((1 << KEYPAD_NUM_ROWS) - 1) << KEYPAD_FIRST_ROW_PIN_ID)
+#define KEYPAD_COLS_MASK                  (((1 << KEYPAD_NUM_COLS) - 1) << KEYPAD_FIRST_COL_PIN_ID)
+
 /* Keypad button logic configurations */
 #define KEYPAD_BUTTON_PRESSED            LOGIC_LOW
 #define KEYPAD_BUTTON_RELEASED           LOGIC_HIGH
 
+/* Returned by KEYPAD_getKey when there is no new key press */
+#define KEYPAD_NO_KEY                    0xFF
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
 /*
  * Description :
- * Get the Keypad pressed button
+ * Initialize the keypad pins and start the tick driven matrix scan.
+ */
+void KEYPAD_init(void);
+
+/*
+ * Description :
+ * Scan one keypad row, should be called from the 1 kHz system tick.
+ * A full matrix scan takes KEYPAD_NUM_ROWS ticks, then all the keys are
+ * debounced together by the debounce service.
+ */
+void KEYPAD_tick(void);
+
+/*
+ * Description :
+ * Return the next debounced key press or KEYPAD_NO_KEY if there is none (non-blocking).
+ * Every physical press is reported once, holding a key does not repeat it.
+ */
+uint8 KEYPAD_getKey(void);
+
+/*
+ * Description :
+ * Wait for the next debounced key press and return the pressed button.
  */
 uint8 KEYPAD_getPressedKey(void);
 
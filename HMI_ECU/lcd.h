@@ -14,6 +14,7 @@
 #define LCD_H_
 
 #include "std_types.h"
+#include "gpio.h" /* For the port and pin IDs used in the configuration checks */
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -44,6 +45,13 @@
 #define LCD_DB6_PIN_ID                 PIN5_ID
 #define LCD_DB7_PIN_ID                 PIN6_ID
 
+/* The data nibble is written with one masked port write, so DB4..DB7 must be consecutive pins */
+#if ((LCD_DB5_PIN_ID != LCD_DB4_PIN_ID + 1) || (LCD_DB6_PIN_ID != LCD_DB4_PIN_ID + 2) || (LCD_DB7_PIN_ID != LCD_DB4_PIN_ID + 3))
+#error "LCD DB4..DB7 should be connected to consecutive pins of the data port"
+#endif
+
+#define LCD_DATA_NIBBLE_MASK           (0x0F << LCD_DB4_PIN_ID)
+
 #endif
 
 /* LCD Commands */
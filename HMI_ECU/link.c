@@ -0,0 +1,164 @@
+/******************************************************************************
+ *
+ * Module: Link
+ *
+ * File Name: link.c
+ *
+ * Description: Source file for the framed messages exchanged between the two ECUs over UART
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "link.h"
+#include "uart.h"
+#include "pool.h"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef enum
+{
+	LINK_WAIT_START,LINK_WAIT_TYPE,LINK_WAIT_LENGTH,LINK_WAIT_PAYLOAD,LINK_WAIT_CHECKSUM
+}LINK_ParserStateType;
+
+/* Compile time check: a received frame is parsed in place in a pool block */
+typedef char LINK_BlockSizeCheckType[(sizeof(LINK_FrameType) <= POOL_BLOCK_SIZE) ? 1 : -1];
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/*
+ * Frame being received, parsed in place in a pool block (main loop only), and the last
+ * complete frame until the application takes it. g_rxFrame is NULL_PTR if the pool was
+ * empty at the START byte, the frame is then parsed to stay in sync but dropped.
+ */
+static LINK_FrameType *g_rxFrame = NULL_PTR;
+static LINK_FrameType *g_readyFrame = NULL_PTR;
+static LINK_ParserStateType g_parserState = LINK_WAIT_START;
+static uint8 g_rxIndex = 0;
+static uint8 g_rxLength = 0;
+static uint8 g_rxChecksum = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Send one frame through UART.
+ */
+void LINK_sendFrame(uint8 type, const uint8 *payload, uint8 length)
+{
+	uint8 checksum = type ^ length;
+	uint8 i;
+
+	UART_sendByte(LINK_FRAME_START);
+	UART_sendByte(type);
+	UART_sendByte(length);
+	for(i = 0; i < length; i++)
+	{
+		UART_sendByte(payload[i]);
+		checksum ^= payload[i];
+	}
+	UART_sendByte(checksum);
+}
+
+/*
+ * Description :
+ * Feed one received byte to the frame parser. Frames with a wrong length or
+ * checksum, or received while the buffer pool is empty, are dropped silently.
+ */
+LINK_ParseResultType LINK_parseByte(uint8 data)
+{
+	switch(g_parserState)
+	{
+	case LINK_WAIT_START:
+		if(data != LINK_FRAME_START)
+		{
+			return LINK_PLAIN_BYTE;
+		}
+		/* The block of a dropped frame is kept for this one */
+		if(g_rxFrame == NULL_PTR)
+		{
+			g_rxFrame = (LINK_FrameType *)POOL_alloc();
+		}
+		g_parserState = LINK_WAIT_TYPE;
+		break;
+	case LINK_WAIT_TYPE:
+		if(g_rxFrame != NULL_PTR)
+		{
+			g_rxFrame->type = data;
+		}
+		g_rxChecksum = data;
+		g_parserState = LINK_WAIT_LENGTH;
+		break;
+	case LINK_WAIT_LENGTH:
+		if(data > LINK_MAX_PAYLOAD)
+		{
+			/* Not a valid frame, resynchronize on the next START */
+			g_parserState = LINK_WAIT_START;
+			break;
+		}
+		if(g_rxFrame != NULL_PTR)
+		{
+			g_rxFrame->length = data;
+		}
+		g_rxChecksum ^= data;
+		g_rxIndex = 0;
+		g_rxLength = data;
+		g_parserState = (data == 0) ? LINK_WAIT_CHECKSUM : LINK_WAIT_PAYLOAD;
+		break;
+	case LINK_WAIT_PAYLOAD:
+		if(g_rxFrame != NULL_PTR)
+		{
+			g_rxFrame->payload[g_rxIndex] = data;
+		}
+		g_rxIndex++;
+		g_rxChecksum ^= data;
+		if(g_rxIndex >= g_rxLength)
+		{
+			g_parserState = LINK_WAIT_CHECKSUM;
+		}
+		break;
+	case LINK_WAIT_CHECKSUM:
+		g_parserState = LINK_WAIT_START;
+		if((data == g_rxChecksum) && (g_rxFrame != NULL_PTR))
+		{
+			/* Hand the block to the application, a frame it did not take is dropped */
+			POOL_free(g_readyFrame);
+			g_readyFrame = g_rxFrame;
+			g_rxFrame = NULL_PTR;
+			return LINK_FRAME_READY;
+		}
+		break;
+	default:
+		g_parserState = LINK_WAIT_START;
+		break;
+	}
+	return LINK_FRAME_BUSY;
+}
+
+/*
+ * Description :
+ * Take the last complete frame (NULL_PTR if none): the frame is not copied, the caller
+ * owns its pool block and gives it back with LINK_freeFrame.
+ */
+LINK_FrameType * LINK_getFrame(void)
+{
+	LINK_FrameType *frame = g_readyFrame;
+
+	g_readyFrame = NULL_PTR;
+	return frame;
+}
+
+/*
+ * Description :
+ * Give the block of a frame taken with LINK_getFrame back to the pool.
+ */
+void LINK_freeFrame(LINK_FrameType * frame)
+{
+	POOL_free(frame);
+}
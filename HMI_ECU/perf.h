@@ -0,0 +1,69 @@
+/******************************************************************************
+ *
+ * Module: Performance Counters
+ *
+ * File Name: perf.h
+ *
+ * Description: Header file for the runtime performance counters
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef PERF_H_
+#define PERF_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Identifies the sender of the counters frames */
+#define PERF_ECU_ID                   0    /* 0 = HMI_ECU, 1 = Control_ECU */
+
+/* Link frames of the counters query */
+#define PERF_QUERY_FRAME              0x13 /* Request, no payload */
+#define PERF_COUNTERS_FRAME           0x14 /* ECU ID, first counter ID, up to PERF_COUNTERS_PER_FRAME counters */
+#define PERF_COUNTERS_PER_FRAME       3    /* 4 bytes each, little endian */
+
+/*
+ * Counter IDs, all counters are 32-bit and wrap around.
+ * The UART counters are the same on both ECUs (updated by the shared UART driver).
+ */
+#define PERF_UART_RX_BYTES            0
+#define PERF_UART_TX_BYTES            1
+#define PERF_UART_FRAME_ERRORS        2    /* FE set in UCSRA */
+#define PERF_UART_OVERRUNS            3    /* DOR set in UCSRA */
+#define PERF_UART_PARITY_ERRORS       4    /* PE set in UCSRA */
+#define PERF_UART_RX_DROPPED          5    /* RX ring buffer full */
+#define PERF_KEY_EVENTS               6
+#define PERF_PASSWORD_ATTEMPTS        7
+#define PERF_LOCKOUTS                 8
+#define PERF_COUNTER_COUNT            9
+
+#define PERF_COUNT(id)                PERF_add((id), 1)
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add value to a counter, safe from the main loop and the ISRs.
+ */
+void PERF_add(uint8 id, uint32 value);
+
+/*
+ * Description :
+ * Copy all the counters at the same instant into counters (PERF_COUNTER_COUNT entries).
+ */
+void PERF_snapshot(uint32 * counters);
+
+/*
+ * Description :
+ * Take a snapshot and send it over UART as PERF_COUNTERS_FRAME frames.
+ */
+void PERF_send(void);
+
+#endif /* PERF_H_ */
@@ -0,0 +1,84 @@
+/******************************************************************************
+ *
+ * Module: Buffer Pool
+ *
+ * File Name: pool.h
+ *
+ * Description: Header file for the fixed-block message buffer pool
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * POOL_BLOCK_COUNT blocks of POOL_BLOCK_SIZE bytes shared by all the message users
+ * (received link frames, passwords), instead of one buffer per layer.
+ * A block holds a whole link frame (type, length, LINK_MAX_PAYLOAD bytes).
+ */
+#define POOL_BLOCK_SIZE               18
+#define POOL_BLOCK_COUNT              4
+
+/* Link frames of the pool occupancy query */
+#define POOL_QUERY_FRAME              0x1A /* Request, no payload */
+#define POOL_REPORT_FRAME             0x1B /* Blocks, free, minimum free, failed allocations (2 bytes, little endian) */
+
+#if (POOL_BLOCK_COUNT > 255)
+#error "POOL_BLOCK_COUNT should fit in a byte"
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef struct
+{
+	uint8 free_blocks;
+	uint8 min_free_blocks; /* Lowest free count since reset (peak occupancy) */
+	uint16 failures;       /* POOL_alloc calls that found the pool empty */
+}POOL_StatsType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Put all the blocks in the free list, call it before the other modules use the pool.
+ */
+void POOL_init(void);
+
+/*
+ * Description :
+ * Take a block from the pool, return NULL_PTR if all blocks are in use.
+ * O(1), safe from the main loop and the ISRs.
+ */
+void * POOL_alloc(void);
+
+/*
+ * Description :
+ * Give a block back to the pool, NULL_PTR is ignored. O(1), safe from the main loop and the ISRs.
+ */
+void POOL_free(void * block);
+
+/*
+ * Description :
+ * Copy the occupancy statistics into the given structure.
+ */
+void POOL_getStats(POOL_StatsType * stats_Ptr);
+
+/*
+ * Description :
+ * Send the occupancy statistics over UART as a POOL_REPORT_FRAME.
+ */
+void POOL_send(void);
+
+#endif /* POOL_H_ */
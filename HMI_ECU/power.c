@@ -0,0 +1,126 @@
+/******************************************************************************
+ *
+ * Module: Power
+ *
+ * File Name: power.c
+ *
+ * Description: Source file for the idle sleep of the wait loops
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "power.h"
+#include "clock.h"
+#include "link.h"
+#include <avr/sleep.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Written by the main loop only */
+static uint32 g_wakeups = 0;
+static uint32 g_sleepMs = 0;
+static uint16 g_sleepUs = 0;      /* Below 1 ms, carried to g_sleepMs */
+static uint32 g_wakeTime = 0;
+static uint8 g_awake = FALSE;     /* No event handled since the last wake-up */
+static uint16 g_lastWakeLatency = 0;
+static uint16 g_maxWakeLatency = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Select the idle sleep mode.
+ */
+void POWER_init(void)
+{
+	set_sleep_mode(SLEEP_MODE_IDLE);
+}
+
+/*
+ * Description :
+ * Sleep in idle mode until the next interrupt. Call it with the interrupts disabled after
+ * checking that there is nothing to do (see POWER_SLEEP_UNLESS): they are enabled together
+ * with the sleep, so the interrupt cannot run between the check and the sleep.
+ * Returns with the interrupts enabled, after the wake-up interrupt ran.
+ */
+void POWER_idle(void)
+{
+	uint32 start = Clock_micros();
+	uint32 asleep;
+
+	sleep_enable();
+	/* The instruction after sei always runs before a pending interrupt */
+	sei();
+	sleep_cpu();
+	sleep_disable();
+
+	/* The wake-up interrupt already ran, it is not part of the wake to handle time */
+	g_wakeTime = Clock_micros();
+	g_awake = TRUE;
+	g_wakeups++;
+
+	/* Idle sleeps are shorter than the 1 ms tick, no division on every wake-up */
+	asleep = CLOCK_ELAPSED(g_wakeTime, start) + g_sleepUs;
+	while(asleep >= 1000)
+	{
+		asleep -= 1000;
+		g_sleepMs++;
+	}
+	g_sleepUs = (uint16)asleep;
+}
+
+/*
+ * Description :
+ * Record the time from the last wake-up to the handling of the event that caused it,
+ * called by the application when it starts handling an event. Only the first call after
+ * a wake-up is recorded.
+ */
+void POWER_eventHandled(void)
+{
+	uint32 latency;
+
+	if(g_awake)
+	{
+		g_awake = FALSE;
+		latency = CLOCK_ELAPSED(Clock_micros(), g_wakeTime);
+		g_lastWakeLatency = (latency > 0xFFFF) ? 0xFFFF : (uint16)latency;
+		if(g_lastWakeLatency > g_maxWakeLatency)
+		{
+			g_maxWakeLatency = g_lastWakeLatency;
+		}
+	}
+}
+
+/*
+ * Description :
+ * Send the wake-ups, the time asleep and the wake to handle times over UART
+ * as a POWER_REPORT_FRAME.
+ */
+void POWER_send(void)
+{
+	uint8 payload[16];
+	uint32 now = Clock_millis();
+
+	payload[0] = (uint8)g_wakeups;
+	payload[1] = (uint8)(g_wakeups >> 8);
+	payload[2] = (uint8)(g_wakeups >> 16);
+	payload[3] = (uint8)(g_wakeups >> 24);
+	payload[4] = (uint8)g_sleepMs;
+	payload[5] = (uint8)(g_sleepMs >> 8);
+	payload[6] = (uint8)(g_sleepMs >> 16);
+	payload[7] = (uint8)(g_sleepMs >> 24);
+	payload[8] = (uint8)now;
+	payload[9] = (uint8)(now >> 8);
+	payload[10] = (uint8)(now >> 16);
+	payload[11] = (uint8)(now >> 24);
+	payload[12] = (uint8)g_lastWakeLatency;
+	payload[13] = (uint8)(g_lastWakeLatency >> 8);
+	payload[14] = (uint8)g_maxWakeLatency;
+	payload[15] = (uint8)(g_maxWakeLatency >> 8);
+	LINK_sendFrame(POWER_REPORT_FRAME, payload, sizeof(payload));
+}
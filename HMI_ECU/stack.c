@@ -0,0 +1,96 @@
+/******************************************************************************
+ *
+ * Module: Stack Monitor
+ *
+ * File Name: stack.c
+ *
+ * Description: Source file for the stack painting and SRAM high-water mark
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "stack.h"
+#include "link.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Linker symbols: start of the static variables, end of the static variables, top of the stack (RAMEND) */
+extern uint8 __data_start;
+extern uint8 _end;
+extern uint8 __stack;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+void STACK_paint(void) __attribute__((naked, used, section(".init1")));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Fill [_end, __stack] with STACK_CANARY. Runs from .init1, before the stack pointer
+ * and the zero register are set up, so it is written in assembly without any stack use.
+ */
+void STACK_paint(void)
+{
+	__asm__ volatile (
+		"    ldi r30, lo8(_end)      \n"
+		"    ldi r31, hi8(_end)      \n"
+		"    ldi r24, %0             \n"
+		"    ldi r25, hi8(__stack)   \n"
+		"    rjmp 2f                 \n"
+		"1:  st Z+, r24              \n"
+		"2:  cpi r30, lo8(__stack)   \n"
+		"    cpc r31, r25            \n"
+		"    brlo 1b                 \n"
+		"    breq 1b                 \n"
+		:: "M" (STACK_CANARY));
+}
+
+/*
+ * Description :
+ * Measure the SRAM usage: scans the painted area up to the first overwritten byte,
+ * call it from the main loop only (up to ~2 KB read).
+ */
+void STACK_getUsage(STACK_UsageType * usage_Ptr)
+{
+	const uint8 *ptr = &_end;
+
+	/* Bytes still holding the pattern were never used by the stack */
+	while((ptr <= &__stack) && (*ptr == STACK_CANARY))
+	{
+		ptr++;
+	}
+
+	usage_Ptr->static_bytes = (uint16)(&_end - &__data_start);
+	usage_Ptr->free_bytes = (uint16)(ptr - &_end);
+	usage_Ptr->max_stack_bytes = (uint16)((&__stack + 1) - ptr);
+	usage_Ptr->total_bytes = (uint16)((&__stack + 1) - &__data_start);
+}
+
+/*
+ * Description :
+ * Measure the SRAM usage and send it over UART as a STACK_REPORT_FRAME.
+ */
+void STACK_send(void)
+{
+	STACK_UsageType usage;
+	uint8 payload[8];
+
+	STACK_getUsage(&usage);
+	payload[0] = (uint8)usage.static_bytes;
+	payload[1] = (uint8)(usage.static_bytes >> 8);
+	payload[2] = (uint8)usage.max_stack_bytes;
+	payload[3] = (uint8)(usage.max_stack_bytes >> 8);
+	payload[4] = (uint8)usage.free_bytes;
+	payload[5] = (uint8)(usage.free_bytes >> 8);
+	payload[6] = (uint8)usage.total_bytes;
+	payload[7] = (uint8)(usage.total_bytes >> 8);
+	LINK_sendFrame(STACK_REPORT_FRAME, payload, sizeof(payload));
+}
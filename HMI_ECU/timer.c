@@ -14,9 +14,28 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
+#if (TIMER0_DISPATCH == TIMER_DISPATCH_RUNTIME)
 static volatile void (*g_Timer0_CallBackPtr)(void) = NULL_PTR;
+#endif
+#if (TIMER1_DISPATCH == TIMER_DISPATCH_RUNTIME)
 static volatile void (*g_Timer1_CallBackPtr)(void) = NULL_PTR;
+#endif
+#if (TIMER2_DISPATCH == TIMER_DISPATCH_RUNTIME)
 static volatile void (*g_Timer2_CallBackPtr)(void) = NULL_PTR;
+#endif
+
+/*
+ * Timer2 has its own clock select encoding (it adds the /32 and /128 prescalers),
+ * so the common Timer_ClockType values are translated through this table.
+ */
+static const uint8 g_Timer2_ClockSelect[] = {
+    0, /* NO_CLOCK   */
+    1, /* CLOCK_1    */
+    2, /* CLOCK_8    */
+    4, /* CLOCK_64   */
+    6, /* CLOCK_256  */
+    7  /* CLOCK_1024 */
+};
 
 void Timer_init(const Timer_ConfigType * Config_Ptr)
 {
@@ -69,13 +88,13 @@ void Timer_init(const Timer_ConfigType * Config_Ptr)
             if (Config_Ptr->timer_mode == NORMAL_MODE)
             {
                 /* Normal Mode */
-                TCCR2 = (1 << FOC2) | (Config_Ptr->timer_clock);
+                TCCR2 = (1 << FOC2) | g_Timer2_ClockSelect[Config_Ptr->timer_clock];
                 TIMSK |= (1 << TOIE2); // Enable overflow interrupt
             }
             else if (Config_Ptr->timer_mode == COMPARE_MODE)
             {
                 /* Compare Mode */
-                TCCR2 = (1 << FOC2) | (1 << WGM21) | (Config_Ptr->timer_clock);
+                TCCR2 = (1 << FOC2) | (1 << WGM21) | g_Timer2_ClockSelect[Config_Ptr->timer_clock];
                 OCR2 = Config_Ptr->timer_compare_MatchValue;
                 TIMSK |= (1 << OCIE2); // Enable compare interrupt
             }
@@ -107,15 +126,24 @@ void Timer_setCallBack(void(*a_ptr)(void), Timer_ID_Type a_timer_ID)
 {
     switch(a_timer_ID)
     {
+#if (TIMER0_DISPATCH == TIMER_DISPATCH_RUNTIME)
         case TIMER0:
             g_Timer0_CallBackPtr = a_ptr;
             break;
+#endif
+#if (TIMER1_DISPATCH == TIMER_DISPATCH_RUNTIME)
         case TIMER1:
             g_Timer1_CallBackPtr = a_ptr;
             break;
+#endif
+#if (TIMER2_DISPATCH == TIMER_DISPATCH_RUNTIME)
         case TIMER2:
             g_Timer2_CallBackPtr = a_ptr;
             break;
+#endif
+        default:
+            /* TIMER_DISPATCH_STATIC: the handler is bound at compile time */
+            break;
     }
 }
 
@@ -123,6 +151,7 @@ void Timer_setCallBack(void(*a_ptr)(void), Timer_ID_Type a_timer_ID)
  *                      Interrupt Service Routines                             *
  *******************************************************************************/
 
+#if (TIMER0_DISPATCH == TIMER_DISPATCH_RUNTIME)
 ISR(TIMER0_OVF_vect)
 {
     if(g_Timer0_CallBackPtr != NULL_PTR)
@@ -138,7 +167,9 @@ ISR(TIMER0_COMP_vect)
         (*g_Timer0_CallBackPtr)();
     }
 }
+#endif
 
+#if (TIMER1_DISPATCH == TIMER_DISPATCH_RUNTIME)
 ISR(TIMER1_OVF_vect)
 {
     if(g_Timer1_CallBackPtr != NULL_PTR)
@@ -154,7 +185,9 @@ ISR(TIMER1_COMPA_vect)
         (*g_Timer1_CallBackPtr)();
     }
 }
+#endif
 
+#if (TIMER2_DISPATCH == TIMER_DISPATCH_RUNTIME)
 ISR(TIMER2_OVF_vect)
 {
     if(g_Timer2_CallBackPtr != NULL_PTR)
@@ -170,4 +203,5 @@ ISR(TIMER2_COMP_vect)
         (*g_Timer2_CallBackPtr)();
     }
 }
+#endif
 
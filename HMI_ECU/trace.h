@@ -0,0 +1,81 @@
+/******************************************************************************
+ *
+ * Module: Trace
+ *
+ * File Name: trace.h
+ *
+ * Description: Header file for the latency trace ring buffer
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Trace points compile to nothing when disabled */
+#define TRACE_ENABLED                 TRUE
+
+/* Number of entries kept (power of 2), the oldest entry is overwritten when full */
+#define TRACE_BUFFER_SHIFT            5
+#define TRACE_BUFFER_SIZE             (1 << TRACE_BUFFER_SHIFT)
+
+/* Link frames of the trace dump */
+#define TRACE_DUMP_REQUEST_FRAME      0x10 /* Request, no payload */
+#define TRACE_ENTRIES_FRAME           0x11 /* Up to TRACE_ENTRIES_PER_FRAME entries, oldest first */
+#define TRACE_END_FRAME               0x12 /* Number of entries sent, number of entries overwritten */
+#define TRACE_ENTRY_SIZE              6    /* Clock_micros time (4 bytes, little endian), id, data */
+#define TRACE_ENTRIES_PER_FRAME       2
+
+/*
+ * Trace point IDs, shared by both ECUs so one host decoder handles both dumps.
+ * HMI_ECU: 0x01..0x1F, Control_ECU: 0x20..0x3F
+ */
+#define TRACE_KEY_PRESSED             0x01 /* data = key */
+#define TRACE_PASSWORD_ENTERED        0x02 /* data = screen */
+#define TRACE_LINK_TX                 0x03 /* data = number of bytes */
+#define TRACE_LINK_RX                 0x04 /* data = received byte */
+#define TRACE_LCD_FLUSH               0x05 /* data = screen drawn */
+#define TRACE_BOOT_DONE               0x06 /* data = first screen after the boot screen */
+
+#define TRACE_PASSWORD_RECEIVED       0x20 /* data = password length */
+#define TRACE_COMMAND_RECEIVED        0x21 /* data = command */
+#define TRACE_EEPROM_READ_START       0x22
+#define TRACE_EEPROM_READ_END         0x23 /* data = EEPROM status */
+#define TRACE_COMPARE_DONE            0x24 /* data = TRUE if the password matches */
+#define TRACE_VERDICT_SENT            0x25 /* data = verdict byte */
+#define TRACE_MOTOR_START             0x26 /* data = target position */
+#define TRACE_MOTOR_STOP              0x27 /* data = move result */
+#define TRACE_BOOT_READY              0x28 /* data = TRUE if provisioned (fast boot) */
+
+#if (TRACE_ENABLED == TRUE)
+#define TRACE_POINT(id, data)         TRACE_record((id), (data))
+#else
+#define TRACE_POINT(id, data)
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Store an entry (time, id, data) in the ring buffer, safe from the main loop and the ISRs.
+ * Use TRACE_POINT so the trace points can be compiled out.
+ */
+void TRACE_record(uint8 id, uint8 data);
+
+/*
+ * Description :
+ * Send the whole ring buffer over UART as TRACE_ENTRIES_FRAME frames followed by a
+ * TRACE_END_FRAME, then empty it. Blocks for the transmission (~300 ms @ 9600 baud).
+ */
+void TRACE_dump(void);
+
+#endif /* TRACE_H_ */
@@ -13,6 +13,21 @@
 #include "uart.h"
 #include "avr/io.h" /* To use the UART Registers */
 #include "common_macros.h" /* To use the macros like SET_BIT */
+#include <avr/interrupt.h> /* For the RX complete ISR */
+#include "perf.h" /* Traffic and error counters */
+#include "lockfree.h" /* For the RX ring buffer */
+#include "power.h" /* To sleep while waiting for a byte */
+
+#if ((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0) || (UART_RX_BUFFER_SIZE > 256)
+#error "UART_RX_BUFFER_SIZE should be a power of 2 up to 256"
+#endif
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* RX ring buffer, filled by the RX complete ISR and emptied by the readers */
+LF_RING_DEFINE(g_rxRing, UART_RX_BUFFER_SIZE);
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -31,8 +46,8 @@ void UART_init(const UART_ConfigType * Config_Ptr) {
     /* Enable double transmission speed */
     UCSRA = (1 << U2X);
 
-    /* Enable receiver and transmitter */
-    UCSRB = (1 << RXEN) | (1 << TXEN);
+    /* Enable receiver, transmitter and the RX complete interrupt */
+    UCSRB = (1 << RXEN) | (1 << TXEN) | (1 << RXCIE);
 
     /* Set UCSRC configuration */
     UCSRC = (1 << URSEL); // Required for setting UCSRC
@@ -67,7 +82,7 @@ void UART_init(const UART_ConfigType * Config_Ptr) {
     }
 
     /* Set baud rate */
-    ubrr_value = (uint16_t)((F_CPU / (Config_Ptr->baud_rate * 8UL)) - 1);
+    ubrr_value = (uint16_t)UART_UBRR_VALUE(Config_Ptr->baud_rate);
     UBRRH = (uint8_t)(ubrr_value >> 8);
     UBRRL = (uint8_t)ubrr_value;
 }
@@ -84,6 +99,7 @@ void UART_sendByte(const uint8 data)
 	 * the UDR register is not empty now
 	 */
 	UDR = data;
+	PERF_COUNT(PERF_UART_TX_BYTES);
 
 	/************************* Another Method *************************
 	UDR = data;
@@ -98,14 +114,35 @@ void UART_sendByte(const uint8 data)
  */
 uint8 UART_recieveByte(void)
 {
-	/* RXC flag is set when the UART receive data so wait until this flag is set to one */
-	while(BIT_IS_CLEAR(UCSRA,RXC)){}
+	uint8 data;
 
-	/*
-	 * Read the received data from the Rx buffer (UDR)
-	 * The RXC flag will be cleared after read the data
-	 */
-    return UDR;		
+	/* Sleep until the RX interrupt stores a byte in the ring buffer */
+	while(!UART_readByte(&data))
+	{
+		POWER_SLEEP_UNLESS(UART_isDataAvailable());
+	}
+
+    return data;
+}
+
+/*
+ * Description :
+ * Non-blocking receive: if a byte was received, store it in data and return TRUE,
+ * otherwise return FALSE immediately.
+ */
+uint8 UART_readByte(uint8 *data)
+{
+	/* Single byte indices, no need to disable the interrupts */
+	return LF_ringGet(&g_rxRing, data);
+}
+
+/*
+ * Description :
+ * Return TRUE if a received byte is waiting in the ring buffer.
+ */
+uint8 UART_isDataAvailable(void)
+{
+	return (LF_ringCount(&g_rxRing) != 0) ? TRUE : FALSE;
 }
 
 /*
@@ -152,3 +189,34 @@ void UART_receiveString(uint8 *Str)
 	/* After receiving the whole string plus the '#', replace the '#' with '\0' */
 	Str[i] = '\0';
 }
+
+/*******************************************************************************
+ *                      Interrupt Service Routines                             *
+ *******************************************************************************/
+
+ISR(USART_RXC_vect)
+{
+	/* The error flags belong to the byte in UDR, read them first. Reading UDR clears the RXC flag */
+	uint8 status = UCSRA;
+	uint8 data = UDR;
+
+	PERF_COUNT(PERF_UART_RX_BYTES);
+	if(BIT_IS_SET(status, FE))
+	{
+		PERF_COUNT(PERF_UART_FRAME_ERRORS);
+	}
+	if(BIT_IS_SET(status, DOR))
+	{
+		PERF_COUNT(PERF_UART_OVERRUNS);
+	}
+	if(BIT_IS_SET(status, PE))
+	{
+		PERF_COUNT(PERF_UART_PARITY_ERRORS);
+	}
+
+	/* The byte is dropped if the buffer is full */
+	if(!LF_ringPut(&g_rxRing, data))
+	{
+		PERF_COUNT(PERF_UART_RX_DROPPED);
+	}
+}
@@ -0,0 +1,177 @@
+/******************************************************************************
+ *
+ * Module: Work Queue
+ *
+ * File Name: work.c
+ *
+ * Description: Source file for the deferred work queue
+ *
+ * Author: Omar Sherif
+ *
+ *******************************************************************************/
+
+#include "work.h"
+#include "link.h"
+#include "lockfree.h"
+#include <util/atomic.h> /* Several ISRs may post to the same queue */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+typedef struct
+{
+	WORK_FunctionType function;
+	uint8 arg;
+}WORK_ItemType;
+
+typedef struct
+{
+	WORK_ItemType items[WORK_QUEUE_SIZE];
+	volatile uint8 head; /* Written by WORK_post */
+	volatile uint8 tail; /* Written by WORK_process */
+	uint8 maxCount;
+}WORK_QueueType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static WORK_QueueType g_queues[WORK_PRIORITY_COUNT];
+static uint16 g_lostItems = 0;
+static uint16 g_maxIrqOff = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Queue function(arg) to run from the main loop. Safe from the ISRs and the main loop,
+ * returns FALSE (and counts the item as lost) if the queue of this priority is full.
+ */
+uint8 WORK_post(WORK_FunctionType function, uint8 arg, WORK_PriorityType priority)
+{
+	WORK_QueueType *queue_Ptr = &g_queues[priority];
+	uint8 posted = FALSE;
+
+	/* A few cycles: the main loop may post too, so the head update must not be interrupted */
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		uint8 head = queue_Ptr->head;
+		uint8 next = (head + 1) & (WORK_QUEUE_SIZE - 1);
+		uint8 count;
+
+		if(next != queue_Ptr->tail)
+		{
+			queue_Ptr->items[head].function = function;
+			queue_Ptr->items[head].arg = arg;
+			queue_Ptr->head = next;
+			posted = TRUE;
+
+			count = (next - queue_Ptr->tail) & (WORK_QUEUE_SIZE - 1);
+			if(count > queue_Ptr->maxCount)
+			{
+				queue_Ptr->maxCount = count;
+			}
+		}
+		else if(g_lostItems != 0xFFFF)
+		{
+			g_lostItems++;
+		}
+	}
+	return posted;
+}
+
+/*
+ * Description :
+ * Run the queued items, highest priority first, until all the queues are empty.
+ * Call it from the main loop only.
+ */
+void WORK_process(void)
+{
+	uint8 priority = 0;
+
+	while(priority < WORK_PRIORITY_COUNT)
+	{
+		WORK_QueueType *queue_Ptr = &g_queues[priority];
+		uint8 tail = queue_Ptr->tail;
+		WORK_ItemType item;
+
+		if(tail == queue_Ptr->head)
+		{
+			priority++;
+			continue;
+		}
+
+		/* Only this function moves the tail, the slot is not reused before the tail moves */
+		LF_BARRIER();
+		item = queue_Ptr->items[tail];
+		LF_BARRIER();
+		queue_Ptr->tail = (tail + 1) & (WORK_QUEUE_SIZE - 1);
+		item.function(item.arg);
+
+		/* The item may have been preempted by more urgent work */
+		priority = 0;
+	}
+}
+
+/*
+ * Description :
+ * Return TRUE if any queue holds an item, used to decide whether the main loop may sleep.
+ */
+uint8 WORK_isPending(void)
+{
+	uint8 priority;
+
+	for(priority = 0; priority < WORK_PRIORITY_COUNT; priority++)
+	{
+		if(g_queues[priority].head != g_queues[priority].tail)
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Keep the worst time spent with the interrupts disabled, reported by the ISRs
+ * that measure their own duration.
+ */
+void WORK_recordIrqOff(uint32 time_us)
+{
+	uint16 time = (time_us > 0xFFFF) ? 0xFFFF : (uint16)time_us;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(time > g_maxIrqOff)
+		{
+			g_maxIrqOff = time;
+		}
+	}
+}
+
+/*
+ * Description :
+ * Send the worst interrupts disabled time, the lost items and the maximum queue
+ * occupancy over UART as a WORK_REPORT_FRAME.
+ */
+void WORK_send(void)
+{
+	uint8 payload[4 + WORK_PRIORITY_COUNT];
+	uint8 priority;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		payload[0] = (uint8)g_maxIrqOff;
+		payload[1] = (uint8)(g_maxIrqOff >> 8);
+		payload[2] = (uint8)g_lostItems;
+		payload[3] = (uint8)(g_lostItems >> 8);
+		for(priority = 0; priority < WORK_PRIORITY_COUNT; priority++)
+		{
+			payload[4 + priority] = g_queues[priority].maxCount;
+		}
+	}
+	LINK_sendFrame(WORK_REPORT_FRAME, payload, sizeof(payload));
+}
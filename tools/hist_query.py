@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""
+Latency histograms export of Control_ECU.
+
+    hist_query.py --port /dev/ttyUSB0        (sends the query, needs pyserial)
+    hist_query.py --file capture.bin         (decodes a raw capture of the answer)
+
+Control_ECU answers HIST_QUERY with a HIST_SUMMARY frame and HIST_BUCKETS frames per
+histogram (see histogram.h). The percentiles are the upper bounds of the buckets.
+"""
+
+import argparse
+import struct
+
+from trace_decode import build_frame, parse_frames
+
+QUERY = 0x15
+SUMMARY = 0x16
+BUCKETS = 0x17
+
+# Histogram names, same order as histogram.h
+NAMES = ["verify", "eeprom", "unlock"]
+
+
+def decode(data):
+    """Return {histogram id: {"samples", "max_us", "base_shift", "buckets"}}."""
+    histograms = {}
+    for frame_type, payload in parse_frames(data):
+        if frame_type == SUMMARY and len(payload) == 11:
+            samples, max_us = struct.unpack_from("<II", payload, 1)
+            histograms[payload[0]] = {"samples": samples, "max_us": max_us,
+                                      "base_shift": payload[9], "buckets": [0] * payload[10]}
+        elif frame_type == BUCKETS and payload[0] in histograms:
+            buckets = histograms[payload[0]]["buckets"]
+            for j in range(2, len(payload) - 1, 2):
+                index = payload[1] + (j - 2) // 2
+                if index < len(buckets):
+                    buckets[index] = struct.unpack_from("<H", payload, j)[0]
+    return histograms
+
+
+def percentile(hist, fraction):
+    """Upper bound in us of the bucket holding the given fraction of the samples."""
+    total = sum(hist["buckets"])
+    if total == 0:
+        return None
+    seen = 0
+    for index, count in enumerate(hist["buckets"]):
+        seen += count
+        if seen >= fraction * total:
+            if index == len(hist["buckets"]) - 1:
+                # Open ended bucket, the max is the only bound
+                return hist["max_us"]
+            return min(1 << (hist["base_shift"] + index), hist["max_us"])
+    return hist["max_us"]
+
+
+def format_ms(time_us):
+    return "-" if time_us is None else "%.3f" % (time_us / 1000.0)
+
+
+def print_histograms(histograms, show_buckets):
+    print("%-10s %8s %12s %12s %12s" % ("histogram", "samples", "p50 [ms]", "p99 [ms]", "max [ms]"))
+    for hist_id in sorted(histograms):
+        hist = histograms[hist_id]
+        name = NAMES[hist_id] if hist_id < len(NAMES) else "hist_%d" % hist_id
+        print("%-10s %8d %12s %12s %12s" % (name, hist["samples"], format_ms(percentile(hist, 0.50)),
+                                            format_ms(percentile(hist, 0.99)),
+                                            format_ms(hist["max_us"] if hist["samples"] else None)))
+        if show_buckets:
+            for index, count in enumerate(hist["buckets"]):
+                if count:
+                    print("    < %12s ms  %6d" % (format_ms(1 << (hist["base_shift"] + index)), count))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="serial port connected to the Control_ECU UART")
+    source.add_argument("--file", help="raw capture of the answer")
+    parser.add_argument("--buckets", action="store_true", help="print the bucket counts too")
+    args = parser.parse_args()
+
+    if args.port:
+        import serial  # pyserial
+        with serial.Serial(args.port, 9600, timeout=1.0) as link:
+            link.reset_input_buffer()
+            link.write(build_frame(QUERY))
+            data = link.read(512)
+    else:
+        with open(args.file, "rb") as capture:
+            data = capture.read()
+    print_histograms(decode(data), args.buckets)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""
+Performance counters query for the door locker ECUs.
+
+    perf_query.py --port /dev/ttyUSB0        (sends the query, needs pyserial)
+    perf_query.py --file capture.bin         (decodes a raw capture of the answer)
+
+The ECU answers PERF_QUERY with PERF_COUNTERS frames holding a snapshot of all its
+counters (see perf.h). Running the query twice gives the rates over the interval.
+"""
+
+import argparse
+import struct
+import time
+
+from trace_decode import build_frame, parse_frames
+
+QUERY = 0x13
+COUNTERS = 0x14
+
+# Counter names by ECU ID, same order as perf.h
+UART_COUNTERS = ["uart_rx_bytes", "uart_tx_bytes", "uart_frame_errors",
+                 "uart_overruns", "uart_parity_errors", "uart_rx_dropped"]
+NAMES = {
+    0: ("HMI_ECU", UART_COUNTERS + ["key_events", "password_attempts", "lockouts"]),
+    1: ("Control_ECU", UART_COUNTERS + ["twi_nacks", "eeprom_retries", "password_attempts",
+                                        "lockouts", "motor_runtime_ms", "pir_motions"]),
+}
+
+
+def decode(data):
+    """Return (ecu id, {counter id: value}) of the last snapshot in data."""
+    ecu = None
+    counters = {}
+    for frame_type, payload in parse_frames(data):
+        if frame_type != COUNTERS or len(payload) < 2:
+            continue
+        ecu, first = payload[0], payload[1]
+        for j in range(2, len(payload) - 3, 4):
+            counters[first + (j - 2) // 4] = struct.unpack_from("<I", payload, j)[0]
+    return ecu, counters
+
+
+def query(link):
+    link.reset_input_buffer()
+    link.write(build_frame(QUERY))
+    return decode(link.read(256))
+
+
+def print_counters(ecu, counters, previous=None, interval=None):
+    ecu_name, names = NAMES.get(ecu, ("ECU %s" % ecu, []))
+    print(ecu_name)
+    for counter_id in sorted(counters):
+        name = names[counter_id] if counter_id < len(names) else "counter_%d" % counter_id
+        line = "  %-20s %10d" % (name, counters[counter_id])
+        if previous is not None and counter_id in previous:
+            delta = (counters[counter_id] - previous[counter_id]) & 0xFFFFFFFF
+            line += "  %10.2f /s" % (delta / interval)
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="serial port connected to the ECU UART")
+    source.add_argument("--file", help="raw capture of the answer")
+    parser.add_argument("--interval", type=float, default=0,
+                        help="query again after this many seconds and print the rates")
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as capture:
+            print_counters(*decode(capture.read()))
+        return
+
+    import serial  # pyserial
+    with serial.Serial(args.port, 9600, timeout=1.0) as link:
+        ecu, counters = query(link)
+        if not args.interval:
+            print_counters(ecu, counters)
+            return
+        start = time.monotonic()
+        time.sleep(args.interval)
+        ecu, later = query(link)
+        print_counters(ecu, later, counters, time.monotonic() - start)
+
+
+if __name__ == "__main__":
+    main()
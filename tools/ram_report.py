@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+Static SRAM breakdown per module, from the object files of one ECU build.
+
+    ram_report.py Control_ECU/*.o
+    ram_report.py --top 10 HMI_ECU/*.o           (also list the largest variables)
+
+On the AVR, .data, .bss and .rodata (string literals, const tables not in PROGMEM)
+all take SRAM. The stack uses what is left: compare with the high-water mark
+returned by the STACK_QUERY link frame (see stack.h).
+"""
+
+import argparse
+import os
+import subprocess
+
+SRAM_SECTIONS = (".data", ".bss", ".rodata")
+SRAM_SYMBOL_TYPES = "bBdDrRC"
+
+
+def section_sizes(size_tool, path):
+    """Return {".data": n, ".bss": n, ".rodata": n} of one object file."""
+    sizes = dict.fromkeys(SRAM_SECTIONS, 0)
+    output = subprocess.run([size_tool, "-A", path], capture_output=True, text=True, check=True).stdout
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) < 2 or not fields[1].isdigit():
+            continue
+        for section in SRAM_SECTIONS:
+            if fields[0] == section or fields[0].startswith(section + "."):
+                sizes[section] += int(fields[1])
+    return sizes
+
+
+def symbols(nm_tool, path):
+    """Return [(size, type, name)] of the variables of one object file."""
+    result = []
+    output = subprocess.run([nm_tool, "-S", path], capture_output=True, text=True, check=True).stdout
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in SRAM_SYMBOL_TYPES:
+            result.append((int(fields[1], 16), fields[2], fields[3]))
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("objects", nargs="+", help="object files of the build")
+    parser.add_argument("--size", default="avr-size", help="size tool (default avr-size)")
+    parser.add_argument("--nm", default="avr-nm", help="nm tool (default avr-nm)")
+    parser.add_argument("--sram", type=int, default=2048, help="SRAM of the part (default 2048, ATmega32)")
+    parser.add_argument("--top", type=int, default=0, help="list the N largest variables")
+    args = parser.parse_args()
+
+    rows = []
+    all_symbols = []
+    for path in args.objects:
+        module = os.path.splitext(os.path.basename(path))[0]
+        sizes = section_sizes(args.size, path)
+        # Tentative definitions (COMMON) are only placed in .bss at link time
+        module_symbols = symbols(args.nm, path)
+        sizes[".bss"] += sum(size for size, kind, _ in module_symbols if kind == "C")
+        rows.append((sum(sizes.values()), module, sizes))
+        all_symbols += [(size, module, name) for size, _, name in module_symbols]
+
+    print("%-16s %7s %7s %7s %7s" % ("module", ".data", ".bss", ".rodata", "total"))
+    for total, module, sizes in sorted(rows, reverse=True):
+        print("%-16s %7d %7d %7d %7d" % (module, sizes[".data"], sizes[".bss"], sizes[".rodata"], total))
+    static = sum(row[0] for row in rows)
+    print("%-16s %31d" % ("static", static))
+    print("%-16s %31d  (%d%% of %d bytes)" % ("left for stack", args.sram - static,
+                                              100 * (args.sram - static) // args.sram, args.sram))
+
+    if args.top:
+        print()
+        print("%-16s %-28s %6s" % ("module", "variable", "bytes"))
+        for size, module, name in sorted(all_symbols, reverse=True)[:args.top]:
+            print("%-16s %-28s %6d" % (module, name, size))
+
+
+if __name__ == "__main__":
+    main()
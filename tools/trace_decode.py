@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""
+Trace dump decoder for the door locker ECUs.
+
+Connect a USB-serial adapter to the UART of one ECU (9600 8N1) and run:
+
+    trace_decode.py --port /dev/ttyUSB0        (sends the dump request, needs pyserial)
+    trace_decode.py --file capture.bin         (decodes a raw capture of the dump)
+
+The ECU answers the request with TRACE_ENTRIES frames followed by a TRACE_END
+frame (see trace.h and link.h). The decoder prints every entry with the time
+since the previous one, then the latency of each stage (min/avg/max).
+"""
+
+import argparse
+import struct
+import sys
+
+FRAME_START = 0x21
+DUMP_REQUEST = 0x10
+ENTRIES = 0x11
+END = 0x12
+ENTRY_SIZE = 6
+
+# Trace point IDs, same values as trace.h
+NAMES = {
+    0x01: "KEY_PRESSED",
+    0x02: "PASSWORD_ENTERED",
+    0x03: "LINK_TX",
+    0x04: "LINK_RX",
+    0x05: "LCD_FLUSH",
+    0x06: "BOOT_DONE",
+    0x20: "PASSWORD_RECEIVED",
+    0x21: "COMMAND_RECEIVED",
+    0x22: "EEPROM_READ_START",
+    0x23: "EEPROM_READ_END",
+    0x24: "COMPARE_DONE",
+    0x25: "VERDICT_SENT",
+    0x26: "MOTOR_START",
+    0x27: "MOTOR_STOP",
+    0x28: "BOOT_READY",
+}
+
+# Stages reported in the breakdown: name, start trace point, end trace point
+STAGES = [
+    ("HMI: '=' to password sent", 0x02, 0x03),
+    ("HMI: password sent to verdict", 0x03, 0x04),
+    ("HMI: verdict to LCD updated", 0x04, 0x05),
+    ("Control: password to EEPROM read", 0x20, 0x22),
+    ("Control: EEPROM read", 0x22, 0x23),
+    ("Control: compare", 0x23, 0x24),
+    ("Control: verdict sent", 0x24, 0x25),
+    ("Control: command to motor start", 0x21, 0x26),
+    ("Control: motor run", 0x26, 0x27),
+]
+
+
+def build_frame(frame_type, payload=b""):
+    checksum = frame_type ^ len(payload)
+    for byte in payload:
+        checksum ^= byte
+    return bytes([FRAME_START, frame_type, len(payload)]) + bytes(payload) + bytes([checksum])
+
+
+def parse_frames(data):
+    """Yield (type, payload) of the valid frames, other bytes are skipped."""
+    i = 0
+    while i + 3 < len(data):
+        if data[i] != FRAME_START:
+            i += 1
+            continue
+        frame_type, length = data[i + 1], data[i + 2]
+        end = i + 3 + length
+        if length > 16 or end >= len(data):
+            i += 1
+            continue
+        payload = data[i + 3:end]
+        checksum = frame_type ^ length
+        for byte in payload:
+            checksum ^= byte
+        if checksum != data[end]:
+            i += 1
+            continue
+        yield frame_type, payload
+        i = end + 1
+
+
+def decode(data):
+    entries = []
+    summary = None
+    for frame_type, payload in parse_frames(data):
+        if frame_type == ENTRIES:
+            for j in range(0, len(payload) - ENTRY_SIZE + 1, ENTRY_SIZE):
+                time_us, trace_id, value = struct.unpack_from("<IBB", payload, j)
+                entries.append((time_us, trace_id, value))
+        elif frame_type == END:
+            summary = (payload[0], payload[1] | (payload[2] << 8))
+    return entries, summary
+
+
+def print_entries(entries):
+    previous = None
+    print("%12s %10s  %-18s %s" % ("time [ms]", "delta [ms]", "event", "data"))
+    for time_us, trace_id, value in entries:
+        delta = "" if previous is None else "%10.3f" % ((time_us - previous) / 1000.0)
+        name = NAMES.get(trace_id, "0x%02X" % trace_id)
+        print("%12.3f %10s  %-18s 0x%02X" % (time_us / 1000.0, delta, name, value))
+        previous = time_us
+
+
+def print_stages(entries):
+    print()
+    print("%-36s %6s %10s %10s %10s" % ("stage", "count", "min [ms]", "avg [ms]", "max [ms]"))
+    for name, start_id, end_id in STAGES:
+        spans = []
+        start = None
+        for time_us, trace_id, _ in entries:
+            if trace_id == start_id:
+                start = time_us
+            elif trace_id == end_id and start is not None:
+                spans.append((time_us - start) / 1000.0)
+                start = None
+        if spans:
+            print("%-36s %6d %10.3f %10.3f %10.3f" %
+                  (name, len(spans), min(spans), sum(spans) / len(spans), max(spans)))
+
+
+def read_port(port, timeout):
+    import serial  # pyserial
+    with serial.Serial(port, 9600, timeout=timeout) as link:
+        link.reset_input_buffer()
+        link.write(build_frame(DUMP_REQUEST))
+        data = bytearray()
+        while True:
+            chunk = link.read(256)
+            if not chunk:
+                break
+            data += chunk
+            if decode(bytes(data))[1] is not None:
+                break
+        return bytes(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="serial port connected to the ECU UART")
+    source.add_argument("--file", help="raw capture of the dump")
+    parser.add_argument("--timeout", type=float, default=2.0, help="serial read timeout in seconds")
+    args = parser.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.timeout)
+    else:
+        with open(args.file, "rb") as capture:
+            data = capture.read()
+
+    entries, summary = decode(data)
+    if summary is None:
+        print("warning: no TRACE_END frame, the dump may be incomplete", file=sys.stderr)
+    elif summary[1]:
+        print("warning: %d entries were overwritten before the dump" % summary[1], file=sys.stderr)
+    print_entries(entries)
+    print_stages(entries)
+
+
+if __name__ == "__main__":
+    main()
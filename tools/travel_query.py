@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""
+Bolt travel times export of Control_ECU.
+
+    travel_query.py --port /dev/ttyUSB0      (sends the query, needs pyserial)
+    travel_query.py --file capture.bin       (decodes a raw capture of the answer)
+
+Control_ECU answers MOTOR_TRAVEL_QUERY with one MOTOR_TRAVEL_REPORT frame per bolt
+position (see dc_motor.h). The times are in ms, the brake time is not included; a
+rising average shows a door getting slower mechanically.
+"""
+
+import argparse
+import struct
+
+from trace_decode import build_frame, parse_frames
+
+QUERY = 0x22
+REPORT = 0x23
+
+# Position names, same order as DcMotor_PositionType
+NAMES = ["unlock", "lock"]
+
+
+def decode(data):
+    """Return {position: {"last", "min", "max", "average", "moves"}}."""
+    positions = {}
+    for frame_type, payload in parse_frames(data):
+        if frame_type == REPORT and len(payload) == 11:
+            last, minimum, maximum, average, moves = struct.unpack_from("<HHHHH", payload, 1)
+            positions[payload[0]] = {"last": last, "min": minimum, "max": maximum,
+                                     "average": average, "moves": moves}
+    return positions
+
+
+def print_positions(positions):
+    print("%-8s %8s %10s %10s %10s %10s" % ("move", "moves", "last [ms]", "min [ms]", "max [ms]", "avg [ms]"))
+    for position in sorted(positions):
+        stats = positions[position]
+        name = NAMES[position] if position < len(NAMES) else "position_%d" % position
+        if stats["moves"] == 0:
+            print("%-8s %8d %10s %10s %10s %10s" % (name, 0, "-", "-", "-", "-"))
+        else:
+            print("%-8s %8d %10d %10d %10d %10d" % (name, stats["moves"], stats["last"], stats["min"],
+                                                    stats["max"], stats["average"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="serial port connected to the Control_ECU UART")
+    source.add_argument("--file", help="raw capture of the answer")
+    args = parser.parse_args()
+
+    if args.port:
+        import serial  # pyserial
+        with serial.Serial(args.port, 9600, timeout=1.0) as link:
+            link.reset_input_buffer()
+            link.write(build_frame(QUERY))
+            data = link.read(64)
+    else:
+        with open(args.file, "rb") as capture:
+            data = capture.read()
+    print_positions(decode(data))
+
+
+if __name__ == "__main__":
+    main()